@@ -0,0 +1,128 @@
+/** \file arena.cpp
+ * Implementation of class Arena.
+ */
+
+#include "arena.h"
+
+#include <new>
+
+/** Sizes are rounded up to a multiple of this, which suits any object. */
+const size_t ALIGNMENT = 16;
+
+/** The usual size of a chunk: large objects get a chunk of their own size. */
+const size_t CHUNK_SIZE = 64 * 1024;
+
+/** \return \a size rounded up to a multiple of ALIGNMENT. */
+static inline size_t aligned(size_t size)
+{
+    return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+/** A block of memory, followed by its data. */
+struct Arena::Chunk
+{
+    /** The next older chunk. */
+    Chunk *next;
+
+    /** The number of bytes of data. */
+    size_t size;
+
+    /** The number of bytes taken, which may exceed \a size when
+     * threads have raced for the last bytes.
+     */
+    volatile gint used;
+
+    char *data()
+    {
+        return reinterpret_cast<char*>(this) + aligned(sizeof(Chunk));
+    }
+};
+
+/** Precedes each object in a chunk. */
+struct Arena::Header
+{
+    /** The previously allocated object that needs destruction. */
+    Header *next;
+
+    /** Destroys the object, or 0. */
+    Destroyer destroy;
+
+    void *object()
+    {
+        return reinterpret_cast<char*>(this) + aligned(sizeof(Header));
+    }
+};
+
+Arena::Arena() : chunks(0), objects(0)
+{}
+
+Arena::~Arena()
+{
+    release();
+}
+
+void *Arena::allocate(size_t size, Destroyer destroy)
+{
+    size_t need = aligned(sizeof(Header)) + aligned(size);
+    Header *header = 0;
+    while (!header)
+    {
+        Chunk *chunk = static_cast<Chunk*>(g_atomic_pointer_get(&chunks));
+        if (chunk)
+        {
+            size_t used = g_atomic_int_exchange_and_add(&chunk->used, need);
+            if (used + need <= chunk->size)
+            {
+                header = reinterpret_cast<Header*>(chunk->data() + used);
+                break;
+            }
+        }
+
+        // The chunk is full: start another.  If another thread has
+        // already done so, use its chunk instead.
+        size_t size = need > CHUNK_SIZE ? need : CHUNK_SIZE;
+        Chunk *fresh = static_cast<Chunk*>(::operator new(aligned(sizeof(Chunk)) + size));
+        fresh->next = chunk;
+        fresh->size = size;
+        fresh->used = 0;
+        if (!g_atomic_pointer_compare_and_exchange(&chunks, chunk, fresh))
+            ::operator delete(fresh);
+    }
+
+    header->destroy = destroy;
+    if (destroy)
+    {
+        Header *next;
+        do
+        {
+            next = static_cast<Header*>(g_atomic_pointer_get(&objects));
+            header->next = next;
+        }
+        while (!g_atomic_pointer_compare_and_exchange(&objects, next, header));
+    }
+    return header->object();
+}
+
+void Arena::forget(void *object)
+{
+    Header *header = reinterpret_cast<Header*>(static_cast<char*>(object) - aligned(sizeof(Header)));
+    header->destroy = 0;
+}
+
+void Arena::release()
+{
+    // Newer objects may refer to older ones, so they go first.
+    for (Header *header = static_cast<Header*>(objects); header; header = header->next)
+        if (header->destroy)
+            header->destroy(header->object());
+    objects = 0;
+
+    Chunk *chunk = static_cast<Chunk*>(chunks);
+    while (chunk)
+    {
+        Chunk *next = chunk->next;
+        ::operator delete(chunk);
+        chunk = next;
+    }
+    chunks = 0;
+}
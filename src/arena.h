@@ -0,0 +1,76 @@
+/** \file arena.h
+ * Declaration of class Arena.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <glibmm.h>
+
+/** An instance provides the memory for the objects of one
+ * compilation: AST nodes, basic blocks and LTSs.  Memory is taken
+ * from large chunks by moving a pointer, and it is all released in
+ * one step when the compilation ends, after the objects have been
+ * destroyed in the reverse order of their allocation.
+ *
+ * Several threads may allocate at once (files are parsed in
+ * parallel) without taking a lock.  Releasing the arena while it is
+ * being used is an error.
+ */
+class Arena
+{
+    public:
+
+        /** Function that destroys an object without freeing its memory. */
+        typedef void (*Destroyer)(void *object);
+
+        /** Construct an empty arena. */
+        Arena();
+
+        /** Destroy the objects and free the memory. */
+        ~Arena();
+
+        /** Allocate memory for an object.
+         * \param size is the size of the object.
+         * \param destroy is called for the object when the arena is
+         *        released, or 0 if the object needs no destruction.
+         * \return the memory, suitably aligned for any object.
+         */
+        void *allocate(size_t size, Destroyer destroy);
+
+        /** Note that the object at \a object, which was allocated by
+         * allocate(), was never constructed, because its constructor
+         * threw.  It will not be destroyed.
+         */
+        static void forget(void *object);
+
+        /** Destroy the objects and free the memory.
+         *  The arena can be used again afterwards.
+         */
+        void release();
+
+        /** A Destroyer for objects of type \a T. */
+        template<typename T>
+        static void destroy(void *object)
+        {
+            static_cast<T*>(object)->~T();
+        }
+
+    private:
+
+        // Not copyable: the arena owns its memory.
+        Arena(const Arena &);
+        void operator=(const Arena &);
+
+        struct Chunk;
+        struct Header;
+
+        /** The chunks, newest first: objects are taken from the first. */
+        volatile gpointer chunks;
+
+        /** The objects to be destroyed, newest first. */
+        volatile gpointer objects;
+};
+
+#endif
@@ -4,9 +4,7 @@
  */
 
 #include "ast.h"
-
-/** Static member used to assign a unique number to each AST node. */
-int BaseNode::nodeCount = 0;
+#include "utilities.h"
 
 // Nodes used by the compiler as basic type descriptors.
 Node BaseNode::theVoidNode            = new VoidTypeNode();
@@ -26,6 +24,35 @@ Node BaseNode::theOutputFileNode      = new FileTypeNode(FILE_OUTPUT);
 
 //Node BaseNode::theSignalNode  = new SignalTypeNode();
 
+// ParseNumbering functions
+
+/** The numbering of the file that each thread is parsing. */
+static GStaticPrivate currentNumbering = G_STATIC_PRIVATE_INIT;
+
+ParseNumbering *ParseNumbering::current()
+{
+    return static_cast<ParseNumbering*>(g_static_private_get(&currentNumbering));
+}
+
+void ParseNumbering::setCurrent(ParseNumbering *numbering)
+{
+    g_static_private_set(&currentNumbering, numbering, 0);
+}
+
+void ParseNumbering::number(CompilationContext & cc)
+{
+    for (vector<Node>::iterator it = nodes.begin(); it != nodes.end(); ++it)
+        (*it)->nodeNum = cc.nodeCount++;
+    for (vector< pair<Node, Node> >::iterator it = caseTemps.begin(); it != caseTemps.end(); ++it)
+    {
+        Symbol name("casetemp" + str(++cc.caseTempNum));
+        static_cast<NameNode*>(it->first)->rename(name);
+        static_cast<NameNode*>(it->second)->rename(name);
+    }
+    nodes.clear();
+    caseTemps.clear();
+}
+
 // BaseNode functions
 
 /** Construct a base node for the AST.
@@ -33,8 +60,24 @@ Node BaseNode::theOutputFileNode      = new FileTypeNode(FILE_OUTPUT);
  * \param kv is the kind of node.
  */
 BaseNode::BaseNode(Errpos ep, NodeKind kv)
-: ep(ep), kv(kv), defChain(0), nodeNum(nodeCount++)
-{}
+: ep(ep), kv(kv), defChain(0), nodeNum(0), typeId(-1)
+{
+    ParseNumbering *numbering = ParseNumbering::current();
+    if (numbering)
+        numbering->addNode(this);
+    else
+        nodeNum = g_atomic_int_exchange_and_add(&CompilationContext::current().nodeCount, 1);
+}
+
+void *BaseNode::operator new(size_t size)
+{
+    return CompilationContext::current().arena.allocate(size, &Arena::destroy<BaseNode>);
+}
+
+void BaseNode::operator delete(void *p)
+{
+    Arena::forget(p);
+}
 
 // Non-virtual functions
 
@@ -88,7 +131,7 @@ void BaseNode::showDebug(string msg) const
 /** Show source code line.  Used for EVM code generation. */
 void BaseNode::showLine(ostream & os)
 {
-    string line = string(ep.pLine);
+    string line = ep.line();
     //   os << "line " << ep.lineNum << ' ' << line.length() << ' ' << line << endl;
 }
 
@@ -345,7 +388,7 @@ EnumTypeNode::EnumTypeNode(Errpos ep, List values)
 : BaseNode(Errpos(), FILE_TYPE_NODE), mode(mode)
 {}
 
-    EnumValueNode::EnumValueNode(Errpos ep, string name, int varNum)
+    EnumValueNode::EnumValueNode(Errpos ep, Symbol name, int varNum)
 : BaseNode(ep, ENUM_VALUE_NODE), name(name), varNum(varNum), type(0), evmBlockNum(0)
 {}
 
@@ -371,7 +414,7 @@ MapTypeNode::MapTypeNode(Errpos ep, Node domainType,
 : BaseNode(ep, FUNC_NODE), name(0), desc(desc), args(args), bb(0)
 {}
 
-NameNode::NameNode(Errpos ep, string value,
+NameNode::NameNode(Errpos ep, Symbol value,
                    Node definition, bool definingOccurrence)
 : BaseNode(ep, NAME_NODE), value(value),
     definition(definition), definingOccurrence(definingOccurrence),
@@ -11,7 +11,9 @@
 #include "functions.h"
 #include "types.h"
 #include "typecodes.h"
+#include "typetable.h"
 #include "lts.h"
+#include "scope.h"
 
 //#include "genassem.h" // Lightning
 
@@ -27,10 +29,14 @@ using namespace std;
 
 // Refer to types.h for definitions of Node, List, etc.
 
-const string BASIO_SYS = "sys";
-const string BASIO_INP = "inp";
-const string BASIO_OUT = "out";
-const string BASIO_ERR = "err";
+const Symbol BASIO_SYS("sys");
+const Symbol BASIO_INP("inp");
+const Symbol BASIO_OUT("out");
+const Symbol BASIO_ERR("err");
+
+// Defined in llvmgen.h, which needs the LLVM headers.
+class LLVMData;
+
 
 /** An instance is passed around the AST for semantic checking. */
 class CheckData
@@ -39,13 +45,12 @@ class CheckData
         /** Construct a \a CheckData object with default fields. */
         CheckData(bool showWarnings);
 
-        /** The set of names already defined in the current scope.  This set is
+        /** The names already defined in the current scope.  This table is
          * used to check name declarations.  A declaration is legal only if the
-         * name declared is not a member of varNames.  At the beginning of a new
-         * scope, the od value of varNames is 'pushed and the current value is
-         * made empty.  At the end of the scope, the old value is 'popped'.
+         * name declared is not in varNames.  Each new scope is entered at its
+         * beginning and left at its end.
          */
-        StringSet varNames;
+        NameTable varNames;
 
         /** The type of this node. */
         Node type;
@@ -69,7 +74,7 @@ class CheckData
         bool withinParamList;
 
         /** The set of field names in a protocol. */
-        StringSet protNames;
+        SymbolSet protNames;
 
         /** Show warning messages. */
         bool showWarnings;
@@ -79,9 +84,14 @@ class CheckData
 class GenData
 {
     public:
-        /** Construct a \a GenData object with default fields. */
+        /** Construct a \a GenData object with default fields,
+         * for the compilation running on this thread.
+         */
         GenData();
 
+        /** The compilation, which numbers blocks, types, fields and selects. */
+        CompilationContext *context;
+
         /** Name of the most recent definition. */
         string entity;
 
@@ -118,6 +128,48 @@ class GenData
         int evmBlockNumber;
 };
 
+/** An instance records the nodes made while one file is parsed.
+ * Files are parsed in parallel, so their nodes are numbered, and the
+ * temporaries of their 'cases' statements named, after parsing and
+ * in file order: the numbers and names are the same in every run,
+ * whatever order the threads ran in.
+ */
+class ParseNumbering
+{
+    public:
+
+        /** \return the numbering of the file that this thread is parsing, or 0. */
+        static ParseNumbering *current();
+
+        /** Make \a numbering that of this thread: 0 for none. */
+        static void setCurrent(ParseNumbering *numbering);
+
+        /** Record \a node, which has just been constructed. */
+        void addNode(Node node)
+        {
+            nodes.push_back(node);
+        }
+
+        /** Record the defining and using occurrences of a temporary. */
+        void addCaseTemp(Node def, Node use)
+        {
+            caseTemps.push_back(make_pair(def, use));
+        }
+
+        /** Number the nodes and name the temporaries, continuing from
+         *  the counters of \a cc.
+         */
+        void number(CompilationContext & cc);
+
+    private:
+
+        /** The nodes, in the order they were constructed. */
+        vector<Node> nodes;
+
+        /** The temporaries, in the order they were made. */
+        vector< pair<Node, Node> > caseTemps;
+};
+
 /** Abstract base class for nodes in the abstract syntax tree (AST). */
 class BaseNode
 {
@@ -178,6 +230,14 @@ class BaseNode
         /** Virtual destructor. */
         virtual ~BaseNode() {}
 
+        /** Allocate a node in the arena of the current compilation.
+         *  Nodes are destroyed when the compilation ends.
+         */
+        static void *operator new(size_t size);
+
+        /** Called only if a node's constructor throws. */
+        static void operator delete(void *p);
+
         /**  Set the definition chain pointer. */
         void setDefChain(Node pdc);
 
@@ -296,8 +356,8 @@ class BaseNode
         /** Perform Lightning assembly. */
         //virtual void genAssem();
 
-        /** Perform Lightning assembly. */
-        virtual void genLLVM();
+        /** Generate LLVM code into the module of \a ld. */
+        virtual void genLLVM(LLVMData & ld);
 
         /** Add a Lightning jump instruction address. */
         virtual void addJumps(Patches keys) { }
@@ -415,7 +475,10 @@ class BaseNode
         virtual string getCommunicator() const;
 
         /** Get the 'name' field of an identifier or value of a TextNode. */
-        virtual string getNameString() const;
+        virtual Symbol getSymbol() const;
+
+        /** Get the text of getSymbol(). */
+        const string & getNameString() const;
 
         /** Get the string that represents the C type of a variable.
          * This should be a C++ name, such as \a int. */
@@ -457,7 +520,13 @@ class BaseNode
         }
 
         /** Use the definition chain to find the definition of a name. */
-        virtual Node lookUp(string value, Errpos ep);
+        virtual Node lookUp(Symbol value, Errpos ep);
+
+        /** Add the names that lookUp() finds in this node itself, not
+         * on the rest of the chain, to \a scope.
+         * \return false if lookUp() cannot be described in this way.
+         */
+        virtual bool define(Scope & scope);
 
         /** Return the definition of a name. */
         virtual Node getDefinition() const;
@@ -593,8 +662,13 @@ class BaseNode
         /** Kind of the node. */
         NodeKind kv;
 
-        /** Counter for nodes: updated by base class constructor only. */
-        static int nodeCount;
+        /** Canonical number of the type that the node denotes, or -1
+         *  if it has not been numbered.
+         */
+        int typeId;
+
+        friend class TypeTable;
+        friend class ParseNumbering;
 };
 
 /** Root node for a complete program. */
@@ -624,7 +698,7 @@ class ProgramNode : public BaseNode
           void genAssem();*/
 
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 
 
 };
@@ -643,11 +717,12 @@ class InstanceNode : public BaseNode
         void prettyPrint(ostream & os, int level = 0) const;
         void show(ostream & os, int level = 0) const;
         bool drawAST(ostream & os, set<int> & nodeNums, int level);
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
+        bool define(Scope & scope);
         Node getName() const;
         List getArgList() const;
         List extract(int & tempNum);
-        string getNameString() const;
+        Symbol getSymbol() const;
         string getFullName(bool withpointer = false) const;
     private:
 
@@ -665,7 +740,7 @@ class InstanceNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Declaration for a C++ function or procedure that is defined externally. */
@@ -692,7 +767,7 @@ class CppNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Body of a procedure with port and variable parameters. */
@@ -715,7 +790,7 @@ class ProcedureNode : public BaseNode
         Node getParam(int index) const;
         List getParamList() const;
         List extract(int & tempNum);
-        string getNameString() const;
+        Symbol getSymbol() const;
         PortKind getPortKind(int slotNum = 0) const;
     private:
 
@@ -732,7 +807,7 @@ class ProcedureNode : public BaseNode
         int typeNum;
 
         /** Name of this process. */
-        string name;
+        Symbol name;
 
         /** Basic blocks for code. */
         BlockList blocks;
@@ -742,7 +817,7 @@ class ProcedureNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Body of a closure with port and variable parameters. */
@@ -767,7 +842,7 @@ class ProcessNode : public BaseNode
         Node getType() const;
         List getParamList() const;
         List extract(int & tempNum);
-        string getNameString() const;
+        Symbol getSymbol() const;
         PortKind getPortKind(int slotNum = 0) const;
     private:
 
@@ -784,7 +859,7 @@ class ProcessNode : public BaseNode
         int typeNum;
 
         /** Name of this process. */
-        string name;
+        Symbol name;
 
         /** Basic blocks for code. */
         BlockList blocks;
@@ -797,7 +872,7 @@ class ProcessNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** The root of a protocol expression tree. */
@@ -819,7 +894,7 @@ class ProtocolNode : public BaseNode
         string getPortBufferName() const;
         string getEVMTypeCode() const;
         Node getType() const;
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
         Node getProtocol();
         List getParamList() const;
         set<Node> getFieldDecs() const;
@@ -847,7 +922,7 @@ class ProtocolNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** A node containing a name and its definition.
@@ -878,7 +953,8 @@ class DefNode : public BaseNode
         int getNumFields() const;
         int getEVMBlockNumber() const;
         List extract(int & tempNum);
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
+        bool define(Scope & scope);
         Node getValue() const;
         Node getType() const;
         Node getProtocol();
@@ -889,7 +965,7 @@ class DefNode : public BaseNode
         string getCTypeString() const;
         string getEType() const;
         string getEVMTypeCode() const;
-        string getNameString() const;
+        Symbol getSymbol() const;
         PortKind getPortKind(int slotNum = 0) const;
         string getPortBufferName() const;
 
@@ -909,7 +985,7 @@ class DefNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Definition of a cell with port and variable parameters. */
@@ -951,7 +1027,7 @@ class CellNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** A sequence (list) of statements. */
@@ -965,7 +1041,8 @@ class SequenceNode : public BaseNode
         void genBlocks(BlockList & blocks, bool storeBlock = false);
         /*void write(ostream & code);*/
         /*void writeParts(ostream & code, WriteMode wm);*/
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
+        bool define(Scope & scope);
         List extract(int & tempNum);
         bool isEmpty() const;
         string getQueueTest() const;
@@ -983,7 +1060,7 @@ class SequenceNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Skip statement. */
@@ -994,7 +1071,8 @@ class SkipNode : public BaseNode
         void bind(Node p);
         void prettyPrint(ostream & os, int level = 0) const;
         void show(ostream & os, int level = 0) const;
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
+        bool define(Scope & scope);
         bool drawAST(ostream & os, set<int> & nodeNums, int level);
 
         /*// Lightning related stuff
@@ -1002,7 +1080,7 @@ class SkipNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Exit statement. */
@@ -1012,7 +1090,8 @@ class ExitNode : public BaseNode
         ExitNode(Errpos ep);
         void bind(Node p);
         void check(CheckData & cd);
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
+        bool define(Scope & scope);
         void gen(GenData gd);
         void genBlocks(BlockList & blocks, bool storeBlock = false);
         void prettyPrint(ostream & os, int level = 0) const;
@@ -1030,7 +1109,7 @@ class ExitNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
     private:
         /** Pointer to parent IfNode, set by \a genass(). */
         Node parent;
@@ -1050,7 +1129,8 @@ class IfNode : public BaseNode
         /*void write(ostream & code);*/
         List extract(int & tempNum);
         /*void writeParts(ostream & code, WriteMode wm);*/
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
+        bool define(Scope & scope);
         void prettyPrint(ostream & os, int level = 0) const;
         void show(ostream  & os, int level = 0) const;
         bool drawAST(ostream & os, set<int> & nodeNums, int level);
@@ -1071,7 +1151,7 @@ class IfNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
         void addJumps(Patches keys)
         {
             for (Patches::iterator i = keys.begin(); i != keys.end(); ++i)
@@ -1091,7 +1171,8 @@ class CondPairNode : public BaseNode
         void gen(GenData gd);
         void genBlocks(BlockList & blocks, bool storeBlock = false);
         /*void write(ostream & code);*/
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
+        bool define(Scope & scope);
         List extract(int & tempNum);
         /*void writeParts(ostream & code, WriteMode wm);*/
         void prettyPrint(ostream & os, int level = 0) const;
@@ -1124,7 +1205,7 @@ class CondPairNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
     private:
         /** Pointer to parent IfNode, set by \a genass(). */
         Node parent;
@@ -1142,7 +1223,8 @@ class LoopNode : public BaseNode
         /*void write(ostream & code);*/
         List extract(int & tempNum);
         /*void writeParts(ostream & code, WriteMode wm);*/
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
+        bool define(Scope & scope);
         void prettyPrint(ostream & os, int level = 0) const;
         void show(ostream & os, int level = 0) const;
         bool drawAST(ostream & os, set<int> & nodeNums, int level);
@@ -1169,7 +1251,7 @@ class LoopNode : public BaseNode
                 jumps.push_back(*i);
         }
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
     private:
         vector<void*> jumps;
 };
@@ -1179,7 +1261,8 @@ class ForNode : public BaseNode
 {
     public:
         ForNode(Errpos ep, Node comp, Node seq);
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
+        bool define(Scope & scope);
         List extract(int & tempNum);
         void bind(Node p);
         void check(CheckData & cd);
@@ -1217,7 +1300,7 @@ class ForNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Any statement */
@@ -1225,7 +1308,8 @@ class AnyNode : public BaseNode
 {
     public:
         AnyNode(Errpos ep, Node comp, Node seq, Node alt);
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
+        bool define(Scope & scope);
         List extract(int & tempNum);
         void bind(Node p);
         void check(CheckData & cd);
@@ -1269,7 +1353,7 @@ class AnyNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Set comprehension */
@@ -1277,7 +1361,8 @@ class ComprehensionNode : public BaseNode
 {
     public:
         ComprehensionNode(Errpos ep, Node var, Node type, Node collection, Node pred);
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
+        bool define(Scope & scope);
         Node getType() const;
         Node makeInit(Node var, Node iter);
         Node makeTermTest(Block bb, Node var, Node iter);
@@ -1328,7 +1413,7 @@ class ComprehensionNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Set corresponding to a range of values */
@@ -1336,7 +1421,8 @@ class RangeNode : public BaseNode
 {
     public:
         RangeNode(Errpos ep, Node type, Node start, Node finish, Node step, bool open, bool ascending);
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
+        bool define(Scope & scope);
         Node makeInit(Node var, Node iter);
         Node makeTermTest(Block bb, Node var, Node iter);
         Node makeStep(Node var, Node iter);
@@ -1383,7 +1469,7 @@ class RangeNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Initialization for range in for/any loop.
@@ -1430,7 +1516,7 @@ class RangeInitNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Termination test for range: generated by compiler. */
@@ -1482,7 +1568,7 @@ class RangeTermNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Step node for range: generated by compiler. */
@@ -1521,7 +1607,7 @@ class RangeStepNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Set corresponding to map variable */
@@ -1529,7 +1615,8 @@ class MapSetNode : public BaseNode
 {
     public:
         MapSetNode(Errpos ep, MapSetKind setKind, Node map);
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
+        bool define(Scope & scope);
         Node makeInit(Node var, Node iter);
         Node makeTermTest(Block bb, Node var, Node iter);
         Node makeStep(Node var, Node iter);
@@ -1576,7 +1663,7 @@ class MapSetNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Initialization for map in for/any loop.
@@ -1623,7 +1710,7 @@ class MapInitNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Termination test for map: generated by compiler. */
@@ -1671,7 +1758,7 @@ class MapTermNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Step node for map: generated by compiler. */
@@ -1716,7 +1803,7 @@ class MapStepNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Set corresponding to enumeration type. */
@@ -1724,7 +1811,8 @@ class EnumSetNode : public BaseNode
 {
     public:
         EnumSetNode(Errpos ep, Node type);
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
+        bool define(Scope & scope);
         Node makeInit(Node var, Node iter);
         Node makeTermTest(Block bb, Node var, Node iter);
         Node makeStep(Node var, Node iter);
@@ -1753,7 +1841,7 @@ class EnumSetNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Initialization for enumeration in for/any loop.
@@ -1781,7 +1869,7 @@ class EnumInitNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Step for enumeration in for/any loop.
@@ -1809,7 +1897,7 @@ class EnumStepNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Termination for enumeration in for/any loop.
@@ -1843,7 +1931,7 @@ class EnumTermNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Match test node: generated by compiler.
@@ -1871,7 +1959,7 @@ class MatchNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Select statement: defines policy, points to options. */
@@ -1884,7 +1972,8 @@ class SelectNode : public BaseNode
         void gen(GenData gd);
         void genBlocks(BlockList & blocks, bool storeBlock = false);
         List extract(int & tempNum);
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
+        bool define(Scope & scope);
         /*void write(ostream & code);*/
         /*void writeParts(ostream & code, WriteMode wm);*/
         void prettyPrint(ostream & os, int level = 0) const;
@@ -1922,7 +2011,7 @@ class SelectNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** One branch of a select statement. */
@@ -1975,7 +2064,7 @@ class OptionNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** An expression p.f, where p is a port name
@@ -1990,7 +2079,7 @@ class DotNode : public BaseNode
         void gen(GenData gd);
         void setDefining(bool def);
         FileMode checkSysIO() const;
-        string getNameString() const;
+        Symbol getSymbol() const;
         string getCTypeString() const;
         string getPortBufferName() const;
         PortKind getPortKind(int slotNum = 0) const;
@@ -2018,7 +2107,7 @@ class DotNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** An expression p?f, where p is a port name
@@ -2034,7 +2123,7 @@ class QueryNode : public BaseNode
         void genBlocks(BlockList & blocks, bool storeBlock = false);
         void setDefining(bool def);
         FileMode checkSysIO() const;
-        string getNameString() const;
+        Symbol getSymbol() const;
         string getCTypeString() const;
         string getPortBufferName() const;
         PortKind getPortKind(int slotNum = 0) const;
@@ -2069,7 +2158,7 @@ class QueryNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Node for pervasive constant definitions. */
@@ -2091,7 +2180,8 @@ class ConstantNode : public BaseNode
         int getEVMBlockNumber() const;
         string getOwner() const;
         string getCTypeString() const;
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
+        bool define(Scope & scope);
         Node getType() const;
 
     private:
@@ -2116,7 +2206,7 @@ class ConstantNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Node used for constant, variable, and port declarations, and
@@ -2151,7 +2241,8 @@ class DecNode : public BaseNode
         int getFieldNum() const;
         int getVarNum() const;
         int getEVMBlockNumber() const;
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
+        bool define(Scope & scope);
         Node getType() const;
         Node getProtocol();
         Node getValue() const;
@@ -2159,7 +2250,7 @@ class DecNode : public BaseNode
         Node getDomainType() const;
         Node getRangeType() const;
         List extract(int & tempNum);
-        string getNameString() const;
+        Symbol getSymbol() const;
         string getCTypeString() const;
         string getEVMTypeCode() const;
         string getFullName(bool withPointer) const;
@@ -2237,7 +2328,7 @@ class DecNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
         int getOffset() const;
         int getTypeCode() const
         {
@@ -2279,7 +2370,7 @@ class BoolNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
         int getTypeCode() const
         {
             return TYPE_BOOL;
@@ -2297,7 +2388,7 @@ class CharNode : public BaseNode
         /*void writeParts(ostream & code, WriteMode wm);*/
         Node getType() const;
         string getCTypeString() const;
-        string getNameString() const;
+        Symbol getSymbol() const;
         string getConstValue() const;
         void prettyPrint(ostream & os, int level = 0) const;
         void show(ostream & os, int level = 0) const;
@@ -2318,7 +2409,7 @@ class CharNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Text literal. */
@@ -2334,7 +2425,7 @@ class TextNode : public BaseNode
         Node getDomainType() const;
         Node getRangeType() const;
         string getCTypeString() const;
-        string getNameString() const;
+        Symbol getSymbol() const;
         string getConstValue() const;
         void prettyPrint(ostream & os, int level = 0) const;
         void show(ostream & os, int level = 0) const;
@@ -2355,7 +2446,7 @@ class TextNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Numeric literal: may be Integer, Float, or Decimal. */
@@ -2398,7 +2489,7 @@ class NumNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
         int getTypeCode() const
         {
             return type->getTypeCode();
@@ -2420,7 +2511,7 @@ class ListopNode : public BaseNode
         void getx(int & fn) const;
         void show(ostream & os, int level = 0) const;
         bool drawAST(ostream & os, set<int> & nodeNums, int level);
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
         List getArgList() const;
         Operator getOp() const;
         LTS *protocolGraph(set<Node> & fieldDecs);
@@ -2439,7 +2530,7 @@ class ListopNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Root of a binary operator expression. */
@@ -2458,7 +2549,8 @@ class BinopNode : public BaseNode
         void getx(int & fn) const;
         bool drawAST(ostream & os, set<int> & nodeNums, int level);
         string getCTypeString() const;
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
+        bool define(Scope & scope);
         Node getType() const;
         List extract(int & tempNum);
         Operator getOp() const;
@@ -2488,7 +2580,7 @@ class BinopNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
         Node getLHS() const
         {
             return lhs;
@@ -2519,7 +2611,8 @@ class CondExprNode : public BaseNode
         void show(ostream & os, int level = 0) const;
         bool drawAST(ostream & os, set<int> & nodeNums, int level);
         string getCTypeString() const;
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
+        bool define(Scope & scope);
         Node getType() const;
         List extract(int & tempNum);
         LTS *processGraph(Node portDec, int loopEnd);
@@ -2548,7 +2641,7 @@ class CondExprNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Root of a unary operator expression/ */
@@ -2568,7 +2661,7 @@ class UnopNode : public BaseNode
         string getCTypeString() const;
         Node getType() const;
         Node getArg() const;
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
         List extract(int & tempNum);
         Operator getOp() const;
         LTS *protocolGraph(set<Node> & fieldDecs);
@@ -2595,7 +2688,7 @@ class UnopNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Subscript expression */
@@ -2618,9 +2711,10 @@ class SubscriptNode : public BaseNode
         Node getDomainType() const;
         Node getDefinition() const;
         List extract(int & tempNum);
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
+        bool define(Scope & scope);
         string getCTypeString() const;
-        string getNameString() const;
+        Symbol getSymbol() const;
         string getFullName(bool withPointer) const;
         string getOwner() const;
         void prettyPrint(ostream & os, int level = 0) const;
@@ -2644,7 +2738,7 @@ class SubscriptNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Subrange expression: a[i..j] */
@@ -2659,7 +2753,8 @@ class SubrangeNode : public BaseNode
         /*void write(ostream & code);*/
         Node getType() const;
         List extract(int & tempNum);
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
+        bool define(Scope & scope);
         string getCTypeString() const;
         void prettyPrint(ostream & os, int level = 0) const;
         void show(ostream & os, int level = 0) const;
@@ -2683,7 +2778,7 @@ class SubrangeNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Iterator statements and expressions */
@@ -2694,7 +2789,8 @@ class IteratorNode : public BaseNode
         void bind(Node p);
         void check(CheckData & cd);
         List extract(int & tempNum);
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
+        bool define(Scope & scope);
         Node getType() const;
         void gen(GenData gd);
         void genBlocks(BlockList & blocks, bool storeBlock = false);
@@ -2723,7 +2819,7 @@ class IteratorNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** The basic type Void. */
@@ -3002,7 +3098,8 @@ class EnumTypeNode : public BaseNode
         int getIntVal() const;
         bool isEnumType() const;
         bool drawAST(ostream & os, set<int> & nodeNums, int level);
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
+        bool define(Scope & scope);
         Node getType() const;
         Node getEnumSize() const;
         Node getDomainType() const;
@@ -3010,7 +3107,7 @@ class EnumTypeNode : public BaseNode
         string getCTypeString() const;
         string getEType() const;
         string getEVMTypeCode() const;
-        string getNameString() const;
+        Symbol getSymbol() const;
         string getDefaultValue() const
         {
             return "0";
@@ -3019,7 +3116,7 @@ class EnumTypeNode : public BaseNode
     private:
 
         /** Intenal name of the type. */
-        string name;
+        Symbol name;
 
         /** List of the EnumValueNode's of the enumeration. */
         List values;
@@ -3061,18 +3158,19 @@ class FileTypeNode : public BaseNode
 class EnumValueNode : public BaseNode
 {
     public:
-        EnumValueNode(Errpos ep, string name, int varNum);
+        EnumValueNode(Errpos ep, Symbol name, int varNum);
         void prettyPrint(ostream & os, int level = 0) const;
         void show(ostream & os, int level = 0) const;
         bool drawAST(ostream & os, set<int> & nodeNums, int level);
         void setType(Node type);
-        string getNameString() const;
+        Symbol getSymbol() const;
         string getOwner() const;
         string getCTypeString() const;
         void bind(Node p);
         void check(CheckData & cd);
         void genBlocks(BlockList & blocks, bool storeBlock = false);
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
+        bool define(Scope & scope);
         Node getType() const;
         int getVarNum() const;
         int getEVMBlockNumber() const;
@@ -3080,7 +3178,7 @@ class EnumValueNode : public BaseNode
     private:
 
         /** The name of the enumerated value. */
-        string name;
+        Symbol name;
 
         /** The position within the definition, numbered from 0. */
         int varNum;
@@ -3096,7 +3194,7 @@ class EnumValueNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Array types. */
@@ -3143,7 +3241,7 @@ class ArrayTypeNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Map (indexed) types. */
@@ -3182,7 +3280,7 @@ class MapTypeNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
         // int getSize() const;
 };
 
@@ -3206,7 +3304,7 @@ class IterTypeNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** The root of a function call expression.
@@ -3231,7 +3329,8 @@ class FunctionNode : public BaseNode
         string getFun() const;
         Node getType() const;
         Node getPort() const;
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
+        bool define(Scope & scope);
         List extract(int & tempNum);
         LTS *processGraph(Node portDec, int loopEnd);
 
@@ -3256,15 +3355,16 @@ class FunctionNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** A defining or defined occurrence of an identifier. */
 class NameNode : public BaseNode
 {
     public:
-        NameNode(Errpos ep, string value, Node definition, bool definingOccurrence);
+        NameNode(Errpos ep, Symbol value, Node definition, bool definingOccurrence);
         void setDefining(bool def);
+        void rename(Symbol name);
         void bind(Node p);
         void tryBind(Node p);
         void check(CheckData & cd);
@@ -3301,7 +3401,7 @@ class NameNode : public BaseNode
         int getNumFields() const;
         int getVarNum() const;
         int getEVMBlockNumber() const;
-        string getNameString() const;
+        Symbol getSymbol() const;
         string getFullName(bool withpointer = false) const;
         string getOwner() const;
         string getCommunicator() const;
@@ -3331,8 +3431,8 @@ class NameNode : public BaseNode
         /** True if this name must be passed by reference to a cell or closure. */
         bool passByReference;
 
-        /** The actual name, as a string. */
-        string value;
+        /** The actual name. */
+        Symbol value;
 
         /** Pointer to definition/declaration, added during binding phase. */
         Node definition;
@@ -3369,7 +3469,7 @@ class NameNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
         int getOffset() const;
         int getTypeCode() const
         {
@@ -3405,7 +3505,7 @@ class RemoveNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** A node generated to send a message unconditionally. */
@@ -3444,7 +3544,7 @@ class SendNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** A node generated to send a message in a select statement. */
@@ -3487,7 +3587,7 @@ class SendOptionNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** A node generated to complete the receive operation. */
@@ -3530,7 +3630,7 @@ class ReceiveNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** A node generated to prepare for a receive operation
@@ -3578,7 +3678,7 @@ class ReceiveOptionNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Definition of a thread. */
@@ -3630,7 +3730,7 @@ class ThreadNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Thread parameter. */
@@ -3652,7 +3752,8 @@ class ThreadParamNode : public BaseNode
         string getOwner() const;
         string getCTypeString() const;
         string getFullName(bool withpointer = false) const;
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
+        bool define(Scope & scope);
         Node getType() const;
         Node getProtocol();
         PortKind getPortKind(int slotNum = 0) const;
@@ -3685,7 +3786,7 @@ class ThreadParamNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Start statement. */
@@ -3701,7 +3802,8 @@ class StartNode : public BaseNode
         void genBlocks(BlockList & blocks, bool storeBlock = false);
         /*void write(ostream & code);*/
         /*void writeParts(ostream & code, WriteMode wm);*/
-        Node lookUp(string value, Errpos ep);
+        Node lookUp(Symbol value, Errpos ep);
+        bool define(Scope & scope);
         List extract(int & tempNum);
 
     private:
@@ -3717,7 +3819,7 @@ class StartNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Thread invocation. */
@@ -3771,7 +3873,7 @@ class ThreadCallNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Start a thread. */
@@ -3799,7 +3901,7 @@ class ThreadStartNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 /** Stop a thread. */
@@ -3824,7 +3926,7 @@ class ThreadStopNode : public BaseNode
           void prepAssem(AssemData aData);
           void genAssem();*/
     public:
-        void genLLVM();
+        void genLLVM(LLVMData & ld);
 };
 
 #endif
@@ -14,6 +14,16 @@ BasicBlock::BasicBlock(int start, int transfer)
 {
 }
 
+void *BasicBlock::operator new(size_t size)
+{
+    return CompilationContext::current().arena.allocate(size, &Arena::destroy<BasicBlock>);
+}
+
+void BasicBlock::operator delete(void *p)
+{
+    Arena::forget(p);
+}
+
 void BasicBlock::add(Node st)
 {
     stmts.push_back(st);
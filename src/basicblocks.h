@@ -23,6 +23,12 @@ class BasicBlock
     public:
         BasicBlock(int start = -1, int transfer = 0);
 
+        /** Allocate a block in the arena of the current compilation. */
+        static void *operator new(size_t size);
+
+        /** Called only if the constructor throws. */
+        static void operator delete(void *p);
+
         /** Add a statement to the statement list. */
         void add(Node st);
 
@@ -5,6 +5,7 @@
  */
 
 #include "ast.h"
+#include "scope.h"
 
 #include<cassert>
 
@@ -18,6 +19,8 @@ using namespace std;
  *  Nodes with subtrees invoke this function recursively.
  *  Definition nodes pass on a pointer to themselves.
  *  Name nodes use the pointer to find the matching definition.
+ *  Nodes that extend the chain also open a Scope and add the nodes
+ *  of the chain to it, so that names are found without walking it.
  *  \param p points to the definition list for this node to use.
  */
 void BaseNode::bind(Node p)
@@ -29,10 +32,12 @@ void BaseNode::tryBind(Node p)
 void ProgramNode::bind(Node p)
 {
     defChain = p;
+    Scope scope(p);
     for (ListIter it = nodes.begin(); it != nodes.end(); ++it)
     {
         (*it)->bind(p);
         p = &(**it);
+        scope.add(p);
     }
 }
 
@@ -46,10 +51,12 @@ void InstanceNode::bind(Node p)
 
 void CppNode::bind(Node p)
 {
+    Scope scope(p);
     for (ListIter it = params.begin(); it != params.end(); ++it)
     {
         (*it)->bind(p);
         p = &(**it);
+        scope.add(p);
     }
     if (type)
         type->bind(p);
@@ -57,20 +64,24 @@ void CppNode::bind(Node p)
 
 void ProcedureNode::bind(Node p)
 {
+    Scope scope(p);
     for (ListIter it = params.begin(); it != params.end(); ++it)
     {
         (*it)->bind(p);
         p = &(**it);
+        scope.add(p);
     }
     seq->bind(p);
 }
 
 void ProcessNode::bind(Node p)
 {
+    Scope scope(p);
     for (ListIter it = params.begin(); it != params.end(); ++it)
     {
         (*it)->bind(p);
         p = &(**it);
+        scope.add(p);
     }
     seq->bind(p);
 }
@@ -84,7 +95,10 @@ void ProtocolNode::bind(Node p)
 /** \todo Postpone setting name in value node. */
 void DefNode::bind(Node p)
 {
+    // The value is bound in a scope that contains the definition itself.
     defChain = p;
+    Scope scope(p);
+    scope.add(this);
     name->bind(this);
     value->bind(this);
 
@@ -95,15 +109,18 @@ void DefNode::bind(Node p)
 
 void CellNode::bind(Node p)
 {
+    Scope scope(p);
     for (ListIter it = params.begin(); it != params.end(); ++it)
     {
         (*it)->bind(p);
         p = &(**it);
+        scope.add(p);
     }
     for (ListIter it = instances.begin(); it != instances.end(); ++it)
     {
         (*it)->bind(p);
         p = &(**it);
+        scope.add(p);
     }
 }
 
@@ -112,12 +129,15 @@ void SequenceNode::bind(Node p)
     // A sequence node must be on the definition chain
     // because it introduces a scope.
     defChain = p;
+    Scope scope(p);
     p = this;
+    scope.add(p);
 
     for (ListIter it = stmts.begin(); it != stmts.end(); ++it)
     {
         (*it)->bind(p);
         p = &(**it);
+        scope.add(p);
     }
 }
 
@@ -137,11 +157,14 @@ void IfNode::bind(Node p)
 void CondPairNode::bind(Node p)
 {
     defChain = p; // 090227
+    Scope scope(p);
     p = this;
+    scope.add(p);
     for (ListIter it = decs.begin(); it != decs.end(); ++it)
     {
         (*it)->bind(p);
         p = &(**it);
+        scope.add(p);
     }
 
     cond->bind(p);
@@ -158,6 +181,8 @@ void ForNode::bind(Node p)
 {
     defChain = p;
     comp->bind(p);
+    Scope scope(p);
+    scope.add(comp);
     seq->bind(comp);
 }
 
@@ -165,7 +190,11 @@ void AnyNode::bind(Node p)
 {
     defChain = p;
     comp->bind(p);
-    seq->bind(comp);
+    {
+        Scope scope(p);
+        scope.add(comp);
+        seq->bind(comp);
+    }
     if (!alt->isEmpty())
         alt->bind(p);
 }
@@ -174,7 +203,9 @@ void ComprehensionNode::bind(Node p)
 {
     defChain = p;
     var->bind(this);
+    Scope scope(p);
     p = this;
+    scope.add(p);
     if (type)
         type->bind(p);
     collection->bind(p);
@@ -360,21 +391,11 @@ void NameNode::bind(Node p)
 
     // Look for the name in definitions on the defChain.
     defChain = p;
-    Node q = 0;
-    while (true)
-    {
-        if (p == 0)
-            // Name undefined: throw an exception to avoid messed-up AST.
-            Error() << " '" << value << "' is either not defined or cannot be used in this context." << ep << THROW;
-        q = p->lookUp(value, ep);
-        if (q)
-        {
-            definition = q; // Bind name to its definition.
-            break;
-        }
-        else
-            p = p->getDefChain();
-    }
+    Node q = Scope::resolve(p, value, ep);
+    if (q == 0)
+        // Name undefined: throw an exception to avoid messed-up AST.
+        Error() << " '" << value << "' is either not defined or cannot be used in this context." << ep << THROW;
+    definition = q; // Bind name to its definition.
 }
 
 void NameNode::tryBind(Node p)
@@ -384,36 +405,28 @@ void NameNode::tryBind(Node p)
         return;
 
     // Look for the name in definitions on the defChain.
+    // If it is undefined, we don't care.
     defChain = p;
-    Node q = 0;
-    while (true)
-    {
-        if (p == 0)
-            // Name undefined but we don't care.
-            return;
-        q = p->lookUp(value, ep);
-        if (q)
-        {
-            definition = q; // Bind name to its definition.
-            break;
-        }
-        else
-            p = p->getDefChain();
-    }
+    Node q = Scope::resolve(p, value, ep);
+    if (q)
+        definition = q; // Bind name to its definition.
 }
 
 void ThreadNode::bind(Node p)
 {
     defChain = p;
+    Scope scope(p);
     for (ListIter it = inputs.begin(); it != inputs.end(); ++it)
     {
         (*it)->bind(p);
         p = &(**it);
+        scope.add(p);
     }
     for (ListIter it = outputs.begin(); it != outputs.end(); ++it)
     {
         (*it)->bind(p);
         p = &(**it);
+        scope.add(p);
     }
     seq->bind(p);
 }
@@ -12,7 +12,7 @@ LTS *DecNode::protocolGraph(set<Node> & fieldDecs)
 {
     fieldDecs.insert(this);
     LTS *plts = new LTS();
-    plts->insert(plts->getStart(), plts->getFinish(), name->getNameString());
+    plts->insert(plts->getStart(), plts->getFinish(), name->getSymbol());
     return plts;
 }
 
@@ -28,7 +28,7 @@ LTS *UnopNode::protocolGraph(set<Node> & fieldDecs)
                 plts->insert(qlts->getTrans());
                 plts->insert(plts->getStart(), qlts->getStart());
                 plts->insert(qlts->getFinish(), plts->getFinish());
-                plts->insert(plts->getStart(), plts->getFinish(), "?");
+                plts->insert(plts->getStart(), plts->getFinish(), ANY_MESSAGE);
             }
             break;
 
@@ -136,7 +136,7 @@ LTS *IfNode::processGraph(Node portDec, int loopEnd)
         plts->insert(qlts->getFinish(), plts->getFinish());
     }
     if (alt->isEmpty())
-        plts->insert(plts->getStart(), plts->getFinish(), "?");
+        plts->insert(plts->getStart(), plts->getFinish(), ANY_MESSAGE);
     else
     {
         LTS *qlts = alt->processGraph(portDec, loopEnd);
@@ -207,7 +207,7 @@ LTS *DotNode::processGraph(Node portDec, int loopEnd)
     Node myPortDec = port->getDefinition();
     if (myPortDec == portDec)
     {
-        string fieldName = field->getNameString();
+        Symbol fieldName = field->getSymbol();
         plts = new LTS();
         plts->insert(plts->getStart(), plts->getFinish(), fieldName);
     }
@@ -223,7 +223,7 @@ LTS *QueryNode::processGraph(Node portDec, int loopEnd)
     Node myPortDec = port->getDefinition();
     if (myPortDec == portDec)
     {
-        string fieldName = field->getNameString();
+        Symbol fieldName = field->getSymbol();
         plts = new LTS();
         plts->insert(plts->getStart(), plts->getFinish(), fieldName);
     }
@@ -32,31 +32,17 @@ set<Node> merge(const set<Node> & a, const set<Node> & b)
 /** Report an error if a name has been defined previously.
  * Otherwise, enter it into the current names list.
  */
-void checkName(CheckData & cd, string name, Errpos ep)
+void checkName(CheckData & cd, Symbol name, Errpos ep)
 {
-    if (cd.varNames.find(name) != cd.varNames.end())
+    if (cd.varNames.contains(name))
         Error() << "Name '" << name << "' has already been defined in this scope." << ep << REPORT;
     cd.varNames.insert(name);
 }
 
-/** Dummy function for checking type equality. */
+/** Types are equal if they have the same canonical number. */
 bool sameType(Node lhs, Node rhs)
 {
-
-    Node lhsType = lhs->kind() == NAME_NODE ? lhs->getValue() : lhs;
-    Node rhsType = rhs->kind() == NAME_NODE ? rhs->getValue() : rhs;
-
-    if (  lhsType->isMapType() &&                 // lhsType->kind() == MAP_TYPE_NODE &&
-        rhsType->isMapType() &&                 //rhsType->kind() == MAP_TYPE_NODE &&
-        sameType(lhsType->getDomainType(), rhsType->getDomainType()) &&
-        sameType(lhsType->getRangeType(), rhsType->getRangeType()) )
-        return true;
-
-    if (  lhsType->isArrayType() &&
-        rhsType->isArrayType() )
-        return true;
-
-    return lhsType == rhsType;
+    return TypeTable::id(lhs) == TypeTable::id(rhs);
 }
 
 FuncDef *getConversion(Node fromType, Node toType)
@@ -71,42 +57,45 @@ FuncDef *getConversion(Node fromType, Node toType)
     //   fromType->showDebug("conversion from");
     //   toType->showDebug("to");
 
+    // Conversions between basic types are tabulated.
+    FuncDef *conv = findConversion(fromType, toType);
+    if (conv)
+        return conv;
+
     // No conversion needed for equal types.
     if (sameType(fromType, toType))
         return funIdentity;
 
+    unsigned toId = TypeTable::id(toType);
+
     // Enumeration can be converted to Integer.
     if (  fromType->isEnumType() &&
-        (toType == BaseNode::theIntegerNode || toType == BaseNode::theUnsignedIntegerNode))
+        (toId == INTEGER_TYPE_ID || toId == UNSIGNED_INTEGER_TYPE_ID))
         return funIdentity;
 
     // Enumeration can be converted to Text.
-    if (fromType->isEnumType() && toType == BaseNode::theTextNode)
+    if (fromType->isEnumType() && toId == TEXT_TYPE_ID)
         return funEnumText;
 
     // No conversion allowed between distinct enumeration types.
     if (fromType->isEnumType() && toType->isEnumType())
         return funBottom;
 
-    // Look for a conversion function.
-    for (FuncIter it = funcDefs.begin(); it != funcDefs.end(); ++it)
-    {
-        if (  (*it)->isConversion() &&
-            sameType((*it)->paramType(), fromType) &&
-            sameType((*it)->resultType(), toType) )
-            return *it;
-    }
-
-    // No conversion possible.
+    // No conversion possible: the conversion functions only
+    // convert between basic types.
     return funBottom;
 }
 
+/** A Text Type is either Char or Text. */
+bool isTextType(unsigned typeId)
+{
+    return typeId == CHAR_TYPE_ID || typeId == TEXT_TYPE_ID;
+}
+
 /** A Text Type is either Char or Text. */
 bool isTextType(Node type)
 {
-    return
-        type == BaseNode::theCharNode ||
-        type == BaseNode::theTextNode;
+    return isTextType(TypeTable::id(type));
 }
 
 /** A numeric type is an enumeration, a Byte or an Integer. */
@@ -127,20 +116,22 @@ bool isNumericType(Node type)
  *  and Integer give Integer. */
 Node joinTypes(Node lhs, Node rhs)
 {
-    if (lhs == BaseNode::theBoolNode && rhs == BaseNode::theBoolNode)
+    unsigned lhsId = TypeTable::id(lhs);
+    unsigned rhsId = TypeTable::id(rhs);
+    if (lhsId == BOOL_TYPE_ID && rhsId == BOOL_TYPE_ID)
         return BaseNode::theBoolNode;
-    else if (isTextType(lhs) && isTextType(rhs))
+    else if (isTextType(lhsId) && isTextType(rhsId))
     {
-        if (lhs == BaseNode::theCharNode && rhs == BaseNode::theCharNode)
+        if (lhsId == CHAR_TYPE_ID && rhsId == CHAR_TYPE_ID)
             return BaseNode::theCharNode;
         else
             return BaseNode::theTextNode;
     }
     else if (isNumericType(lhs) && isNumericType(rhs))
     {
-        if (lhs == BaseNode::theFloatNode || rhs == BaseNode::theFloatNode)
+        if (lhsId == FLOAT_TYPE_ID || rhsId == FLOAT_TYPE_ID)
             return BaseNode::theFloatNode;
-        if (lhs == BaseNode::theDecimalNode || rhs == BaseNode::theDecimalNode)
+        if (lhsId == DECIMAL_TYPE_ID || rhsId == DECIMAL_TYPE_ID)
             return BaseNode::theDecimalNode;
         else
             return BaseNode::theIntegerNode;
@@ -219,28 +210,29 @@ void checkProtocol(Node portDec, Node closure, Node seq, PortKind pk, bool warni
     Node prot = portDec->getProtocol();
     LTS *protLTS = prot->getLTS();
 
+    ostream & diag = CompilationContext::current().diagnostics();
     switch (pk)
     {
         case CLIENT:
             if (warnings &&  ! satisfies(protLTS, seqLTS))
             {
-                cerr << "Warning: protocol '" << portDec->getNameString() <<
+                diag << "Warning: protocol '" << portDec->getNameString() <<
                     "' does not satisfy client '" << closure->getNameString() <<
                     "'.\nProtocol: " << protLTS << "\nCode:     " << seqLTS << "\n";
-                cerr << endl;
+                diag << endl;
             }
             break;
         case SERVER:
             if (warnings &&  ! satisfies(seqLTS, protLTS))
             {
-                cerr << "Warning: server '" << closure->getNameString() <<
+                diag << "Warning: server '" << closure->getNameString() <<
                     "' does not satisfy protocol '" << portDec->getNameString() <<
                     "'.\nCode:     " << seqLTS << "\nProtocol: " << protLTS << "\n";
-                cerr << endl;
+                diag << endl;
             }
             break;
         default:
-            cerr << "Warning: port should indicate client or server." << portDec->getPos();
+            diag << "Warning: port should indicate client or server." << portDec->getPos();
             break;
     }
 }
@@ -274,7 +266,7 @@ struct Entry
     int numClients;
 };
 
-typedef map<string, Entry> PortTable;
+typedef map<Symbol, Entry> PortTable;
 
 /** Add an entry to a list of port entries. */
 void addPort(PortTable & ports, Node p, bool param)
@@ -285,7 +277,7 @@ void addPort(PortTable & ports, Node p, bool param)
         case DEC_NODE:
             if (p->isPort())
             {
-                string name = p->getNameString();
+                Symbol name = p->getSymbol();
                 PortKind portDir = p->getPortKind();
                 ports.insert(make_pair(name, Entry(param, portDir, ep)));
             }
@@ -304,7 +296,7 @@ void addPort(PortTable & ports, Node p, bool param)
                 {
                     if ((*ita)->kind() == NAME_NODE)
                     {
-                        string name = (*ita)->getNameString();
+                        Symbol name = (*ita)->getSymbol();
                         if ((*itp)->kind() == DEC_NODE && (*itp)->isPort())
                         {
                             PortKind portDir = (*itp)->getPortKind();
@@ -362,7 +354,7 @@ void matchArg(Node & arg, Node par)
             set<Node> fields = merge(argProt->getFieldDecs(), parProt->getFieldDecs());
             for (set<Node>::iterator i = fields.begin(); i != fields.end(); ++i)
                 for (set<Node>::iterator j = i; j != fields.end(); ++j)
-                    if (i != j && (*i)->getNameString() == (*j)->getNameString())
+                    if (i != j && (*i)->getSymbol() == (*j)->getSymbol())
                     {
                         //                  cerr << "Tieing " << (*i)->getNameString() << " and " << (*j)->getNameString() << endl; // 090207
                         Node t = (*i)->getTie();
@@ -493,7 +485,7 @@ void DefNode::check(CheckData & cd)
     name->check(cd);
     value->check(cd);
     if (incremental)
-        cerr << "Warning: '+=' is not implemented yet; '=' assumed." << ep;
+        CompilationContext::current().diagnostics() << "Warning: '+=' is not implemented yet; '=' assumed." << ep;
 }
 
 void InstanceNode::check(CheckData & cd)
@@ -523,8 +515,7 @@ void InstanceNode::check(CheckData & cd)
 
 void CppNode::check(CheckData & cd)
 {
-    StringSet outer = cd.varNames;
-    cd.varNames = StringSet();
+    cd.varNames.enter();
     cd.withinParamList = true;
     for (ListIter it = params.begin(); it != params.end(); ++it)
         (*it)->check(cd);
@@ -540,15 +531,14 @@ void CppNode::check(CheckData & cd)
                 (*it)->setReference();
         }
     }
-    cd.varNames = outer;
+    cd.varNames.leave();
     if (type)
         type->check(cd);
 }
 
 void ProcedureNode::check(CheckData & cd)
 {
-    StringSet outer = cd.varNames;
-    cd.varNames = StringSet();
+    cd.varNames.enter();
     cd.withinParamList = true;
     for (ListIter it = params.begin(); it != params.end(); ++it)
         (*it)->check(cd);
@@ -565,13 +555,12 @@ void ProcedureNode::check(CheckData & cd)
                 (*it)->setReference();
         }
     }
-    cd.varNames = outer;
+    cd.varNames.leave();
 }
 
 void ProcessNode::check(CheckData & cd)
 {
-    StringSet outer = cd.varNames;
-    cd.varNames = StringSet();
+    cd.varNames.enter();
     cd.withinParamList = true;
     for (ListIter it = params.begin(); it != params.end(); ++it)
         (*it)->check(cd);
@@ -588,13 +577,12 @@ void ProcessNode::check(CheckData & cd)
                 (*it)->setReference();
         }
     }
-    cd.varNames = outer;
+    cd.varNames.leave();
 }
 
 void CellNode::check(CheckData & cd)
 {
-    StringSet outer = cd.varNames;
-    cd.varNames = StringSet();
+    cd.varNames.enter();
     cd.withinParamList = true;
     for (ListIter it = params.begin(); it != params.end(); ++it)
         (*it)->check(cd);
@@ -629,14 +617,14 @@ void CellNode::check(CheckData & cd)
             }
         }
     }
-    cd.varNames = outer;
+    cd.varNames.leave();
 }
 
 void ProtocolNode::check(CheckData & cd)
 {
     cd.withinProtocol = true;
 
-    cd.protNames = StringSet();
+    cd.protNames = SymbolSet();
     if (expr)
         expr->check(cd);
 
@@ -650,12 +638,11 @@ void ProtocolNode::check(CheckData & cd)
 
 void SequenceNode::check(CheckData & cd)
 {
-    StringSet outer = cd.varNames;
-    cd.varNames = StringSet();
+    cd.varNames.enter();
     for (ListIter it = stmts.begin(); it != stmts.end(); ++it)
         (*it)->check(cd);
     cd.type = BaseNode::theVoidNode;
-    cd.varNames = outer;
+    cd.varNames.leave();
 }
 
 void ExitNode::check(CheckData & cd)
@@ -695,21 +682,20 @@ void LoopNode::check(CheckData & cd)
 
 void ForNode::check(CheckData & cd)
 {
-    StringSet outer = cd.varNames;
-    cd.varNames = StringSet();
+    cd.varNames.enter();
     comp->check(cd);
     seq->check(cd);
-    cd.varNames = outer;
+    cd.varNames.leave();
 }
 
 void AnyNode::check(CheckData & cd)
 {
-    StringSet outer = cd.varNames;
+    cd.varNames.mark();
     comp->check(cd);
     seq->check(cd);
     if (!alt->isEmpty())
         alt->check(cd);
-    cd.varNames = outer;
+    cd.varNames.leave();
 }
 
 void ComprehensionNode::check(CheckData & cd)
@@ -1366,7 +1352,7 @@ void EnumTypeNode::check(CheckData & cd)
     for (ListIter i = values.begin(); i != values.end(); ++i)
     {
         for (ListIter j = i + 1; j != values.end(); ++j)
-            if ((*i)->getNameString() == (*j)->getNameString())
+            if ((*i)->getSymbol() == (*j)->getSymbol())
                 Error() << "Enumeration name used twice." << (*j)->getPos() << REPORT;
         (*i)->check(cd);
     }
@@ -1428,39 +1414,40 @@ void FunctionNode::check(CheckData & cd)
         return;
     }
 
-    int minConversions = MAX_CONV;
-    FuncDef *bestFunction = 0;
-    bool nameFound = false;
+    Symbol funName = name->getSymbol();
+    if ( ! isFunctionName(funName))
+    {
+        Error() << "There is no function with this name." << ep << REPORT;
+        return;
+    }
+
+    List argTypes;
+    for (ListIter it = args.begin(); it != args.end(); ++it)
+        argTypes.push_back((*it)->getType());
 
-    // Find matching functions and count conversions needed.
-    for (FuncIter it = funcDefs.begin(); it != funcDefs.end(); ++it)
+    // Calls with the same argument types choose the same function.
+    FuncDef *bestFunction = findOverload(funName, argTypes);
+    if ( ! bestFunction)
     {
-        if ((*it)->getUserName() == name->getNameString())
+        // Find matching functions and count conversions needed.
+        int minConversions = MAX_CONV;
+        const vector<FuncDef*> & candidates = findFunctions(funName, args.size());
+        for (FuncIter it = candidates.begin(); it != candidates.end(); ++it)
         {
-            nameFound = true;
-            List params = (*it)->getParams();
-            if (params.size() == args.size())
+            int nc = countConversions((*it)->getParams(), args);
+            if (minConversions > nc)
             {
-                int nc = countConversions(params, args);
-                if (minConversions > nc)
-                {
-                    minConversions = nc;
-                    bestFunction = *it;
-                }
+                minConversions = nc;
+                bestFunction = *it;
             }
         }
-    }
-
-    if ( ! nameFound)
-    {
-        Error() << "There is no function with this name." << ep << REPORT;
-        return;
-    }
 
-    if (minConversions == MAX_CONV)
-    {
-        Error() << "The function cannot be applied to the given arguments." << ep << REPORT;
-        return;
+        if (minConversions == MAX_CONV)
+        {
+            Error() << "The function cannot be applied to the given arguments." << ep << REPORT;
+            return;
+        }
+        rememberOverload(funName, argTypes, bestFunction);
     }
     desc = bestFunction;
     cd.type = bestFunction->resultType();
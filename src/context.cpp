@@ -0,0 +1,74 @@
+/** \file context.cpp
+ * Implementation of class CompilationContext.
+ */
+
+#include "context.h"
+
+#include <llvm/LLVMContext.h>
+#include <llvm/Module.h>
+#include <glibmm.h>
+#include <unistd.h>
+
+using namespace std;
+
+Options::Options()
+    : drawAST(false), showBasicBlocks(false), showFuncs(false),
+      logParse(false), logExtract(false), logBind(false), logCheck(false), logGen(false),
+      comRun(false), tracing(false), maxCycles(100), outfilename(""),
+      showWarnings(false), genLLVM(false),
+      emitBitcode(false), emitAssembly(false), emitObject(false), debugInfo(false),
+      useCache(false), hotThreshold(1000), threads(0),
+      preludeFileName("prelude.cpp"), runtimeFileName("mert.bc")
+{}
+
+CompilationContext::CompilationContext()
+    : diagnosticStream(0), errors(0), nodeCount(0), caseTempNum(0),
+      blockNumber(0), varCounter(0), typeCounter(0), fieldCounter(0), selCounter(0),
+      nextState(0), scope(0), llvmContext(0), module(0)
+{}
+
+CompilationContext::~CompilationContext()
+{
+    delete module;
+    delete llvmContext;
+}
+
+/** The context of each thread.  Static initialisation makes it
+ * usable before the thread system is initialised.
+ */
+static GStaticPrivate currentContext = G_STATIC_PRIVATE_INIT;
+
+/** The context of threads that have not set one: it holds the
+ * nodes that are built at startup, such as the basic types.  It is
+ * constructed on first use, because those nodes are static.
+ */
+static CompilationContext & defaultContext()
+{
+    static CompilationContext theContext;
+    return theContext;
+}
+
+CompilationContext & CompilationContext::current()
+{
+    CompilationContext *context =
+        static_cast<CompilationContext*>(g_static_private_get(&currentContext));
+    return context ? *context : defaultContext();
+}
+
+void CompilationContext::setCurrent(CompilationContext *context)
+{
+    g_static_private_set(&currentContext, context, 0);
+}
+
+unsigned CompilationContext::workers() const
+{
+    if (options.threads > 0)
+        return options.threads;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return cores > 0 ? cores : 1;
+}
+
+ostream & CompilationContext::diagnostics()
+{
+    return diagnosticStream ? *diagnosticStream : cerr;
+}
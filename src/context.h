@@ -0,0 +1,229 @@
+/** \file context.h
+ * Declaration of class CompilationContext.
+ */
+
+#ifndef CONTEXT_H
+#define CONTEXT_H
+
+#include "arena.h"
+#include "source.h"
+#include "typetable.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <glibmm.h>
+
+using namespace std;
+
+class Scope;
+
+namespace llvm
+{
+    class LLVMContext;
+    class Module;
+}
+
+/** The compiler options, which are set by command-line arguments. */
+struct Options
+{
+    /** Construct the default options. */
+    Options();
+
+    /** Compiler option  "A": Write AST to a file. */
+    bool drawAST;
+
+    /** Compiler option  "B": Write basic blocks to log file. */
+    bool showBasicBlocks;
+
+    /** Compiler option  "F": Write function descriptors to log file. */
+    bool showFuncs;
+
+    /** Compiler option  "LP": write log files after parsing. */
+    bool logParse;
+
+    /** Compiler option  "LE": write log files after extracting. */
+    bool logExtract;
+
+    /** Compiler option  "LB": write log files after binding. */
+    bool logBind;
+
+    /** Compiler option  "LC": write log files after checking. */
+    bool logCheck;
+
+    /** Compiler option  "LG": write log files after code generation. */
+    bool logGen;
+
+    /** Compiler option "R": compile and run.
+     *  If this is enabled, no C++ code is generated.
+     */
+    bool comRun;
+
+    /** Compiler option  "T": Trace execution */
+    bool tracing;
+
+    /** Compiler option  "T": Number of cycles to trace. */
+    int maxCycles;
+
+    /** Compiler option  "O": output file nane. */
+    Glib::ustring outfilename;
+
+    /** Compiler option  "W": show warning messages. */
+    bool showWarnings;
+
+    /** Compiler option  "Z": generate LLVM bitcode. */
+    bool genLLVM;
+
+    /** Compiler option  "ZB": write LLVM bitcode to a .bc file. */
+    bool emitBitcode;
+
+    /** Compiler option  "ZL": write LLVM assembly to a .ll file. */
+    bool emitAssembly;
+
+    /** Compiler option  "ZO": write a native object to a .o file. */
+    bool emitObject;
+
+    /** Compiler option  "ZG": generate DWARF line information and
+     *  write JIT-compiled functions to /tmp/perf-<pid>.map.
+     */
+    bool debugInfo;
+
+    /** Compiler option  "K": keep compiled code in a cache (under the
+     *  user's cache directory) and reuse it when nothing has changed:
+     *  the whole program with +R, and otherwise the LLVM code of the
+     *  process types and procedures of each module whose text, and
+     *  whose imports, are unchanged.  Such a module is still parsed,
+     *  bound and checked, and the C++ code is still written: only its
+     *  LLVM generation and optimisation are skipped.  Off by default,
+     *  so that nothing is written to the cache unless it is asked for.
+     */
+    bool useCache;
+
+    /** Number of activations after which +R optimises a process type. */
+    unsigned hotThreshold;
+
+    /** Number of threads that parse and generate code for the program,
+     *  or 0 for one per processor.  Batch compilation (+J) uses one,
+     *  because it compiles programs in parallel instead.
+     */
+    unsigned threads;
+
+    /** Compiler option  "P": path to 'prelude.cpp'. */
+    Glib::ustring preludeFileName;
+
+    /** Compiler option  "P": path to 'mert.bc', the run-time library as LLVM bitcode. */
+    Glib::ustring runtimeFileName;
+
+    /** Compiler option  "C": names of C++ files to be included in output. */
+    vector<Glib::ustring> cppfilenames;
+};
+
+/** An instance holds everything that belongs to one compilation:
+ * its options, its source files, the memory for its nodes, the
+ * counters that number nodes, states, blocks and types, and the
+ * LLVM module that receives its code.  Compilations with different contexts are independent and
+ * may run at the same time on different threads.
+ *
+ * The context is passed to the phases that need it (see GenData).
+ * Code that is not given it, such as node constructors, uses the
+ * context of its thread; threads that work for a compilation must
+ * call setCurrent() first.
+ */
+class CompilationContext
+{
+    public:
+
+        /** Construct a context with default options and no module. */
+        CompilationContext();
+
+        /** Delete the module and the LLVM context. */
+        ~CompilationContext();
+
+        /** \return the context of the compilation running on this thread,
+         * or a shared default context if none has been set.
+         */
+        static CompilationContext & current();
+
+        /** Make \a context the context of this thread.
+         * \param context may be 0 to return to the default context.
+         */
+        static void setCurrent(CompilationContext *context);
+
+        /** \return the number of threads that may work for the compilation. */
+        unsigned workers() const;
+
+        /** \return the stream that receives error messages, warnings and
+         *  progress messages.
+         */
+        ostream & diagnostics();
+
+        /** Options for the compilation. */
+        Options options;
+
+        /** Source files of the program. */
+        SourceManager sources;
+
+        /** Memory for the nodes, basic blocks and LTSs of the program. */
+        Arena arena;
+
+        /** Names of the files written by the compilation. */
+        vector<string> outputFiles;
+
+        /** Stream for error messages, warnings and progress messages,
+         * or 0 for standard error.  Batch compilation (+J) collects them
+         * for each program.
+         */
+        ostream *diagnosticStream;
+
+        /** Number of errors found: updated atomically. */
+        int errors;
+
+        /** Counter for AST nodes: updated atomically.  Nodes made while
+         * files are parsed in parallel are numbered afterwards, in file
+         * order (see ParseNumbering).
+         */
+        int nodeCount;
+
+        /** Counter for temporary expressions generated for 'cases'
+         * statements: updated atomically, and used like \a nodeCount.
+         */
+        int caseTempNum;
+
+        /** Unique labels for switch cases in generated code. */
+        int blockNumber;
+
+        /** Unique Number for variable. */
+        int varCounter;
+
+        /** Unique number for process type. */
+        int typeCounter;
+
+        /** Number for protocol field: unique within protocol. */
+        int fieldCounter;
+
+        /** Number for select statement: unique within process. */
+        int selCounter;
+
+        /** Next state number for labelled transition systems. */
+        int nextState;
+
+        /** The innermost scope of the binding pass, or 0. */
+        Scope *scope;
+
+        /** The canonical numbers of the program's types. */
+        TypeTable types;
+
+        /** The LLVM context that owns the module's types and constants, or 0. */
+        llvm::LLVMContext *llvmContext;
+
+        /** The LLVM module that receives the program, or 0. */
+        llvm::Module *module;
+
+    private:
+
+        // Not copyable: the context owns its sources and module.
+        CompilationContext(const CompilationContext &);
+        void operator=(const CompilationContext &);
+};
+
+#endif
@@ -124,7 +124,7 @@ bool BaseNode::drawAST(ostream & os, set<int> & nodeNums, int level)
         nodeNums.insert(nodeNum);
         os << '(' << nodeToString(kv) << ' ' << nodeNum << ' ';
                 os << drawInt("line", ep.lineNum);
-                os << drawInt("col", ep.charPos);
+                os << drawInt("col", ep.column());
                 return true;
     }
 
@@ -170,7 +170,7 @@ bool ProcessNode::drawAST(ostream & os, set<int> & nodeNums, int level)
 {
     if (BaseNode::drawAST(os, nodeNums, level))
     {
-        os << drawAttr("name", name);
+        os << drawAttr("name", name.str());
         os << drawInt("id", typeNum);
         for (ListIter it = params.begin(); it != params.end(); ++it)
             (*it)->drawAST(os, nodeNums, level + 2);
@@ -540,7 +540,7 @@ bool DecNode::drawAST(ostream & os, set<int> & nodeNums, int level)
                     // v: T := p.f
                     os << "(DecReceive " << num() << ' ';
                             os << drawInt("line", ep.lineNum);
-                            os << drawInt("col", ep.charPos);
+                            os << drawInt("col", ep.column());
                             drawSubTree(os, name, nodeNums, level + 2);
                             drawSubTree(os, type, nodeNums, level + 2);
                             drawSubTree(os, value, nodeNums, level + 2);
@@ -550,7 +550,7 @@ bool DecNode::drawAST(ostream & os, set<int> & nodeNums, int level)
                     // v: T := e
                     os << "(DecInit " << num() << ' ';
                             os << drawInt("line", ep.lineNum);
-                            os << drawInt("col", ep.charPos);
+                            os << drawInt("col", ep.column());
                             os << drawBool("constant", constant);
                             drawSubTree(os, name, nodeNums, level + 2);
                             drawSubTree(os, type, nodeNums, level + 2);
@@ -562,7 +562,7 @@ bool DecNode::drawAST(ostream & os, set<int> & nodeNums, int level)
                 // type, no value => declaration
                 os << "(Dec " << num() << ' ';
                         os << drawInt("line", ep.lineNum);
-                        os << drawInt("col", ep.charPos);
+                        os << drawInt("col", ep.column());
                         os << drawBool("ref", reference);
                         os << drawAttr("port", portToString(portDir));
                         drawSubTree(os, name, nodeNums, level + 2);
@@ -580,7 +580,7 @@ bool DecNode::drawAST(ostream & os, set<int> & nodeNums, int level)
                     // send
                     os << "(Send " << num() << ' ';
                             os << drawInt("line", ep.lineNum);
-                            os << drawInt("col", ep.charPos);
+                            os << drawInt("col", ep.column());
                             drawSubTree(os, name, nodeNums, level + 2);
                             drawSubTree(os, value, nodeNums, level + 2);
                 }
@@ -589,7 +589,7 @@ bool DecNode::drawAST(ostream & os, set<int> & nodeNums, int level)
                     // receive
                     os << "(Receive " << num() << ' ';
                             os << drawInt("line", ep.lineNum);
-                            os << drawInt("col", ep.charPos);
+                            os << drawInt("col", ep.column());
                             drawSubTree(os, name, nodeNums, level + 2);
                             drawSubTree(os, value, nodeNums, level + 2);
                 }
@@ -598,7 +598,7 @@ bool DecNode::drawAST(ostream & os, set<int> & nodeNums, int level)
                     // assign
                     os << "(Assign " << num() << ' ';
                             os << drawInt("line", ep.lineNum);
-                            os << drawInt("col", ep.charPos);
+                            os << drawInt("col", ep.column());
                             drawSubTree(os, name, nodeNums, level + 2);
                             drawSubTree(os, value, nodeNums, level + 2);
                 }
@@ -608,7 +608,7 @@ bool DecNode::drawAST(ostream & os, set<int> & nodeNums, int level)
                 // no type, no value => signal
                 os << "(SendSignal " << num() << ' ';
                         os << drawInt("line", ep.lineNum);
-                        os << drawInt("col", ep.charPos);
+                        os << drawInt("col", ep.column());
                         drawSubTree(os, name, nodeNums, level + 2);
             }
             else if (ck == RECEIVE)
@@ -616,7 +616,7 @@ bool DecNode::drawAST(ostream & os, set<int> & nodeNums, int level)
                 // no type, no value => signal
                 os << "(ReceiveSignal " << num() << ' ';
                         os << drawInt("line", ep.lineNum);
-                        os << drawInt("col", ep.charPos);
+                        os << drawInt("col", ep.column());
                         drawSubTree(os, name, nodeNums, level + 2);
             }
             else
@@ -864,7 +864,7 @@ bool EnumValueNode::drawAST(ostream & os, set<int> & nodeNums, int level)
 {
     if (BaseNode::drawAST(os, nodeNums, level))
     {
-        os << drawAttr("name", name);
+        os << drawAttr("name", name.str());
         type->drawAST(os, nodeNums, level + 2);
         os << '\n' << setw(level) << ' ' << ')';
     }
@@ -905,7 +905,7 @@ bool NameNode::drawAST(ostream & os, set<int> & nodeNums, int level)
 {
     if (BaseNode::drawAST(os, nodeNums, level))
     {
-        os << drawAttr("value", value);
+        os << drawAttr("value", value.str());
         os << drawBool("defocc", definingOccurrence);
         os << drawInt("uid", varNum);
         os << drawInt("field", fieldNum);
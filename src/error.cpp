@@ -2,13 +2,20 @@
 
 #include "error.h"
 
-int numErrors = 0;
+#include <glibmm.h>
+
+/** Keeps reports from threads that parse in parallel from mixing. */
+static Glib::StaticMutex reportMutex = GLIBMM_STATIC_MUTEX_INIT;
 
 Error & Error::operator<<(const ErrorReporter & rep)
 {
-    ++numErrors;
+    CompilationContext & cc = CompilationContext::current();
+    g_atomic_int_inc(&cc.errors);
     if (rep == REPORT)
-        cerr << os.str();
+    {
+        Glib::StaticMutex::Lock lock(reportMutex);
+        cc.diagnostics() << os.str();
+    }
     else
         throw Glib::ustring(os.str());
     return *this;
@@ -16,6 +23,6 @@ Error & Error::operator<<(const ErrorReporter & rep)
 
 int errorCount()
 {
-    return numErrors;
+    return g_atomic_int_get(&CompilationContext::current().errors);
 }
 
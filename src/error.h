@@ -12,33 +12,50 @@
 #include <stdexcept>
 #include <glibmm.h>
 
+#include "context.h"
+
 using namespace std;
 
-/** An instance records the position of a character in the source text. */
+/** An instance records the position of a character in the source text.
+ * The text itself is kept by the source manager of the compilation,
+ * which provides the line when an error is reported.
+ */
 struct Errpos
 {
     /** Construct a position object for reporting an error.
-     * \param pLine points to the source code line.
+     * \param file is the number of the source file in the source manager.
+     * \param offset is the offset of the character in the file.
      * \param lineNum is the number of the source code line.
-     * \param charPos is the position of the character on the line.
      */
-    Errpos(Glib::ustring pLine = "", int lineNum = 0, int charPos = 0)
-        : pLine(pLine), lineNum(lineNum), charPos(charPos)
+    Errpos(int file = NO_FILE, unsigned offset = 0, int lineNum = 0)
+        : file(file), offset(offset), lineNum(lineNum)
     {}
 
-    /** The destructor doesn't do anything special. */
-    ~Errpos()
+    /** \return the source code line, or an empty string if there is none. */
+    Glib::ustring line() const
+    {
+        return file == NO_FILE ? Glib::ustring() :
+               CompilationContext::current().sources.lineText(file, offset);
+    }
+
+    /** \return the position of the character on its line.  This is
+     * found from the text, so it is only worth calling for output.
+     */
+    int column() const
     {
-        // pLine should not be deleted when a position object is deleted.
+        return file == NO_FILE ? 0 :
+               CompilationContext::current().sources.column(file, offset);
     }
 
     /** Write an error position, displaying the whole line and a caret. */
     friend ostream & operator<<(ostream & os, const Errpos & ep)
     {
-        if (ep.pLine.size())
+        Glib::ustring pLine = ep.line();
+        if (pLine.size())
         {
-            os << '\n' << setw(4) << ep.lineNum << ": " << ep.pLine << "\n      ";
-            for (int i = 0; i < ep.charPos; ++i)
+            os << '\n' << setw(4) << ep.lineNum << ": " << pLine << "\n      ";
+            int col = ep.column();
+            for (int i = 0; i < col; ++i)
                 os << ' ';
             os << "^\n";
         }
@@ -47,14 +64,14 @@ struct Errpos
         return os;
     }
 
-    /** Pointer to source line. */
-    Glib::ustring pLine;
+    /** Number of source file, or NO_FILE. */
+    short file;
+
+    /** Offset of the character in the source file. */
+    unsigned offset;
 
     /** Number of source line. */
     int lineNum;
-
-    /** Position of character in source line. */
-    int charPos;
 };
 
 /** An instance is used to determine how an error is handled.
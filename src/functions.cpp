@@ -8,6 +8,7 @@
 #include <cassert>
 #include <map>
 #include <fstream>
+#include <glibmm.h>
 using namespace std;
 
 /** Convert a name to 'keyword' font and escape underlines. */
@@ -80,6 +81,79 @@ void showFuncDefs(const char *coerceFileName, const char *funFileName, vector<Fu
     fns.close();
 }
 
+// The functions in the table, indexed by name and number of parameters.
+static map<pair<Symbol, size_t>, vector<FuncDef*> > functionIndex;
+
+// The names of the functions in the table.
+static SymbolSet functionNames;
+
+/** Index the functions by name and number of parameters. */
+static void indexFuncDefs(const vector<FuncDef*> & funcDefs)
+{
+    functionIndex.clear();
+    functionNames.clear();
+    for (vector<FuncDef*>::const_iterator it = funcDefs.begin(); it != funcDefs.end(); ++it)
+    {
+        Symbol name((*it)->getUserName());
+        functionIndex[make_pair(name, (*it)->getParams().size())].push_back(*it);
+        functionNames.insert(name);
+    }
+}
+
+bool isFunctionName(Symbol name)
+{
+    return functionNames.find(name) != functionNames.end();
+}
+
+const vector<FuncDef*> & findFunctions(Symbol name, size_t arity)
+{
+    static const vector<FuncDef*> none;
+    map<pair<Symbol, size_t>, vector<FuncDef*> >::const_iterator it =
+        functionIndex.find(make_pair(name, arity));
+    return it == functionIndex.end() ? none : it->second;
+}
+
+// The functions chosen for calls, keyed by the function name and the
+// numbers of the argument types.  Programs are checked in parallel in
+// batch mode, so the cache is guarded by a mutex.
+static map<vector<unsigned>, FuncDef*> overloads;
+static Glib::StaticMutex overloadsMutex = GLIBMM_STATIC_MUTEX_INIT;
+
+/** Make the key for a call of \a name with arguments of types \a argTypes.
+ * \return false if some type is not basic, and so cannot be in a key.
+ */
+static bool overloadKey(Symbol name, const List & argTypes, vector<unsigned> & key)
+{
+    key.push_back(name.id());
+    for (ListIter it = argTypes.begin(); it != argTypes.end(); ++it)
+    {
+        int num = basicTypeNumber(*it);
+        if (num < 0)
+            return false;
+        key.push_back(num);
+    }
+    return true;
+}
+
+FuncDef *findOverload(Symbol name, const List & argTypes)
+{
+    vector<unsigned> key;
+    if ( ! overloadKey(name, argTypes, key))
+        return 0;
+    Glib::StaticMutex::Lock lock(overloadsMutex);
+    map<vector<unsigned>, FuncDef*>::const_iterator it = overloads.find(key);
+    return it == overloads.end() ? 0 : it->second;
+}
+
+void rememberOverload(Symbol name, const List & argTypes, FuncDef *fun)
+{
+    vector<unsigned> key;
+    if ( ! overloadKey(name, argTypes, key))
+        return;
+    Glib::StaticMutex::Lock lock(overloadsMutex);
+    overloads[key] = fun;
+}
+
 void buildFuncDefs(vector<FuncDef*> & funcDefs)
 {
 
@@ -445,6 +519,8 @@ void buildFuncDefs(vector<FuncDef*> & funcDefs)
     funBottom = new FuncDef("bot", "", NO_OP, BaseNode::theVoidNode, false);
     funEnumText = new FuncDef("enumText", "", NO_OP, BaseNode::theVoidNode, false);
     funIntegerEnum = new FuncDef("intEnum", "", NO_OP, BaseNode::theVoidNode, false);
+
+    indexFuncDefs(funcDefs);
 }
 
 
@@ -463,5 +539,47 @@ FuncDef *funEnumText;
 // A special function, used internally to generate call to a run-time check function.
 FuncDef *funIntegerEnum;
 
+// The conversion matrix: the conversion from type f to type t is at f * NUM_BASIC_TYPES + t.
+static vector<FuncDef*> conversions;
+
+void buildConversions(const vector<FuncDef*> & funcDefs)
+{
+    TypeTable::numberBasicTypes();
+
+    conversions.assign(NUM_BASIC_TYPES * NUM_BASIC_TYPES, funBottom);
+    for (unsigned i = 0; i < NUM_BASIC_TYPES; ++i)
+        conversions[i * NUM_BASIC_TYPES + i] = funIdentity;
+
+    // When there are several conversions for a pair, the first is used.
+    // Enumerations, arrays and maps are not basic: their conversions
+    // depend on the particular type.
+    for (vector<FuncDef*>::const_reverse_iterator it = funcDefs.rbegin(); it != funcDefs.rend(); ++it)
+    {
+        if ( ! (*it)->isConversion())
+            continue;
+        int from = basicTypeNumber((*it)->paramType());
+        int to = basicTypeNumber((*it)->resultType());
+        if (from >= 0 && to >= 0 && from != to)
+            conversions[from * NUM_BASIC_TYPES + to] = *it;
+    }
+}
+
+int basicTypeNumber(Node type)
+{
+    unsigned id = TypeTable::id(type);
+    return id < NUM_BASIC_TYPES ? id : -1;
+}
+
+FuncDef *findConversion(Node fromType, Node toType)
+{
+    int from = basicTypeNumber(fromType);
+    if (from < 0)
+        return 0;
+    int to = basicTypeNumber(toType);
+    if (to < 0)
+        return 0;
+    return conversions[from * NUM_BASIC_TYPES + to];
+}
+
 
 
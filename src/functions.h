@@ -100,6 +100,43 @@ extern FuncDef *funIntegerEnum;
 
 void buildFuncDefs(vector<FuncDef*> & funcDefs);
 
+/** Number the basic types and record the conversion between each pair
+ *  of them, so that conversions between basic types are found by
+ *  indexing rather than by searching the function table.
+ *  Call this once, after buildFuncDefs().
+ */
+void buildConversions(const vector<FuncDef*> & funcDefs);
+
+/** \return the conversion from \a fromType to \a toType: funIdentity
+ *  if none is needed and funBottom if none exists.  \return 0 if either
+ *  type is not a basic type, for the caller to decide.
+ */
+FuncDef *findConversion(Node fromType, Node toType);
+
+/** \return the number of \a type in the conversion matrix,
+ *  or -1 if it is not a basic type.
+ */
+int basicTypeNumber(Node type);
+
+/** \return true if some function in the table is called \a name. */
+bool isFunctionName(Symbol name);
+
+/** \return the functions in the table that are called \a name and
+ *  take \a arity parameters, in table order.
+ */
+const vector<FuncDef*> & findFunctions(Symbol name, size_t arity);
+
+/** \return the function that was chosen for an earlier call of \a name
+ *  with arguments of types \a argTypes, or 0 if there was none.
+ */
+FuncDef *findOverload(Symbol name, const List & argTypes);
+
+/** Record that \a fun was chosen for a call of \a name with arguments
+ *  of types \a argTypes.  The choice is only recorded if the types are
+ *  basic, because other types belong to a particular compilation.
+ */
+void rememberOverload(Symbol name, const List & argTypes, FuncDef *fun);
+
 void showFuncDefs(const char *coerceFileName, const char *funFileName, vector<FuncDef*> fds);
 
 #endif
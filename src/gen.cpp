@@ -10,21 +10,6 @@
 #include "ast.h"
 #include "utilities.h"
 
-/** Unique labels for switch cases in generated code. */
-int blockNumber = 0;
-
-/** Unique Number for variable. */
-int varCounter = 0;
-
-/** Unique number for process type. */
-int typeCounter = 0;
-
-/** Number for protocol field: unique within protocol. */
-int fieldCounter = 0;
-
-/** Number for select statement: unique within process. */
-int selCounter = 0;
-
 /** Add a block to the blocks list and set its transfer addresses.
  *  \param blocks is the list of blocks.
  *  \param endLabel is the transfer label for the current block.
@@ -50,7 +35,7 @@ void addBlock(BlockList & blocks, int endLabel, int startLabel, int altLabel = -
  *  abstract syntax tree during the first phase of code generation.
  */
 GenData::GenData() :
-    selNum(-1), loopEnd(-1), ifEnd(-1), testGuard(-1),
+    context(&CompilationContext::current()), selNum(-1), loopEnd(-1), ifEnd(-1), testGuard(-1),
     execBranch(-1), selectStart(-1), selectEnd(-1), seqIndex(-1)
 {}
 
@@ -91,8 +76,8 @@ void InstanceNode::genBlocks(BlockList & blocks, bool storeBlock)
 
 void ProcedureNode::gen(GenData gd)
 {
-    typeNum = ++typeCounter;
-    start = ++blockNumber;
+    typeNum = ++gd.context->typeCounter;
+    start = ++gd.context->blockNumber;
     for (ListIter it = params.begin(); it != params.end(); ++it)
         (*it)->gen(gd);
     seq->gen(gd);
@@ -100,7 +85,7 @@ void ProcedureNode::gen(GenData gd)
 
 void ProcedureNode::genBlocks(BlockList &, bool storeBlock)
 {
-    selCounter = 0;
+    CompilationContext::current().selCounter = 0;
     BasicBlock *pb = new BasicBlock(start);
     pb->setClosure(this);
     blocks.push_back(pb);
@@ -115,8 +100,8 @@ void ProcedureNode::genBlocks(BlockList &, bool storeBlock)
 void ProcessNode::gen(GenData gd)
 {
     evmBlockNum = gd.evmBlockNumber;
-    typeNum = ++typeCounter;
-    start = ++blockNumber;
+    typeNum = ++gd.context->typeCounter;
+    start = ++gd.context->blockNumber;
     for (ListIter it = params.begin(); it != params.end(); ++it)
         (*it)->gen(gd);
     seq->gen(gd);
@@ -124,7 +109,7 @@ void ProcessNode::gen(GenData gd)
 
 void ProcessNode::genBlocks(BlockList &, bool storeBlock)
 {
-    selCounter = 0;
+    CompilationContext::current().selCounter = 0;
     BasicBlock *pb = new BasicBlock(start);
     pb->setClosure(this);
     blocks.push_back(pb);
@@ -142,12 +127,12 @@ void ProtocolNode::gen(GenData gd)
     evmBlockNum = gd.evmBlockNumber;
     // Find the highest field counter assigned so far.
     // This avoids duplicate field numbers due to tieing.
-    fieldCounter = 0;
-    expr->getx(fieldCounter);
+    gd.context->fieldCounter = 0;
+    expr->getx(gd.context->fieldCounter);
     //   cerr << "Field counter = " << fieldCounter << endl; // 090207
     if (expr)
         expr->gen(gd);
-    numFields = fieldCounter;
+    numFields = gd.context->fieldCounter;
     //   showDebug("ProtocolNode::gen"); //090207
 }
 
@@ -207,7 +192,7 @@ void ExitNode::genBlocks(BlockList & blocks, bool storeBlock)
 
 void IfNode::gen(GenData gd)
 {
-    ifEnd = ++blockNumber;
+    ifEnd = ++gd.context->blockNumber;
     gd.ifEnd = ifEnd;
     for (ListIter it = condPairs.begin(); it != condPairs.end(); ++it)
         (*it)->gen(gd);
@@ -224,8 +209,8 @@ void IfNode::genBlocks(BlockList & blocks, bool storeBlock)
 
 void CondPairNode::gen(GenData gd)
 {
-    condTrue = ++blockNumber;
-    condFalse = ++blockNumber;
+    condTrue = ++gd.context->blockNumber;
+    condFalse = ++gd.context->blockNumber;
     ifEnd = gd.ifEnd;
     for (ListIter it = decs.begin(); it != decs.end(); ++it)
         (*it)->gen(gd);
@@ -246,8 +231,8 @@ void CondPairNode::genBlocks(BlockList & blocks, bool storeBlock)
 
 void LoopNode::gen(GenData gd)
 {
-    loopStart = ++blockNumber;
-    loopEnd = ++blockNumber;
+    loopStart = ++gd.context->blockNumber;
+    loopEnd = ++gd.context->blockNumber;
     gd.loopEnd = loopEnd;
     seq->gen(gd);
 }
@@ -261,11 +246,11 @@ void LoopNode::genBlocks(BlockList & blocks, bool storeBlock)
 
 void ForNode::gen(GenData gd)
 {
-    forMore = ++blockNumber;
-    forMatch = ++blockNumber;
-    forBody = ++blockNumber;
-    forStep = ++blockNumber;
-    forEnd = ++blockNumber;
+    forMore = ++gd.context->blockNumber;
+    forMatch = ++gd.context->blockNumber;
+    forBody = ++gd.context->blockNumber;
+    forStep = ++gd.context->blockNumber;
+    forEnd = ++gd.context->blockNumber;
 
     comp->gen(gd);
     seq->gen(gd);
@@ -287,12 +272,12 @@ void ForNode::genBlocks(BlockList & blocks, bool storeBlock)
 
 void AnyNode::gen(GenData gd)
 {
-    anyMore = ++blockNumber;
-    anyFound = ++blockNumber;
-    anyStep = ++blockNumber;
-    anyBody = ++blockNumber;
-    anyElse = ++blockNumber;
-    anyEnd = ++blockNumber;
+    anyMore = ++gd.context->blockNumber;
+    anyFound = ++gd.context->blockNumber;
+    anyStep = ++gd.context->blockNumber;
+    anyBody = ++gd.context->blockNumber;
+    anyElse = ++gd.context->blockNumber;
+    anyEnd = ++gd.context->blockNumber;
 
     comp->gen(gd);
     seq->gen(gd);
@@ -332,8 +317,8 @@ void ComprehensionNode::genBlocks(BlockList & blocks, bool storeBlock)
 
 void RangeNode::gen(GenData gd)
 {
-    finishNum = ++blockNumber; // varCounter++;
-    stepNum = ++blockNumber; // varCounter++;
+    finishNum = ++gd.context->blockNumber; // varCounter++;
+    stepNum = ++gd.context->blockNumber; // varCounter++;
 
     owner = gd.entity;
     start->gen(gd);
@@ -358,7 +343,7 @@ void RangeNode::genBlocks(BlockList & blocks, bool storeBlock)
 void MapSetNode::gen(GenData gd)
 {
     owner = gd.entity;
-    indexName = "index" + str(++blockNumber);
+    indexName = "index" + str(++gd.context->blockNumber);
     map->gen(gd);
 }
 
@@ -370,21 +355,21 @@ void SelectNode::gen(GenData gd)
 {
     owner = gd.entity;
 
-    selNum = ++selCounter;
+    selNum = ++gd.context->selCounter;
     gd.selNum = selNum;
 
-    selectStart = ++blockNumber;
+    selectStart = ++gd.context->blockNumber;
     gd.selectStart = selectStart;
 
-    selectEnd = ++blockNumber;
+    selectEnd = ++gd.context->blockNumber;
     gd.selectEnd = selectEnd;
 
     numBranches = 0;
     for (ListIter it = options.begin(); it != options.end(); ++it)
     {
         ++numBranches;
-        gd.testGuard = ++blockNumber;
-        gd.execBranch = ++blockNumber;
+        gd.testGuard = ++gd.context->blockNumber;
+        gd.execBranch = ++gd.context->blockNumber;
         (*it)->gen(gd);
     }
 }
@@ -443,7 +428,7 @@ void QueryNode::genBlocks(BlockList & blocks, bool storeBlock)
 
 void ConstantNode::gen(GenData gd)
 {
-    evmBlockNum = ++blockNumber;
+    evmBlockNum = ++gd.context->blockNumber;
     name->gen(gd);
     type->gen(gd);
     value->gen(gd);
@@ -455,17 +440,17 @@ void ConstantNode::genBlocks(BlockList & blocks, bool storeBlock)
 
 void NumNode::gen(GenData gd)
 {
-    evmBlockNum = ++blockNumber;
+    evmBlockNum = ++gd.context->blockNumber;
 }
 
 void CharNode::gen(GenData gd)
 {
-    evmBlockNum = ++blockNumber;
+    evmBlockNum = ++gd.context->blockNumber;
 }
 
 void TextNode::gen(GenData gd)
 {
-    evmBlockNum = ++blockNumber;
+    evmBlockNum = ++gd.context->blockNumber;
 }
 
 void DecNode::gen(GenData gd)
@@ -476,8 +461,8 @@ void DecNode::gen(GenData gd)
     if (value)
         value->gen(gd);
     //   evmBlockNum = ++blockNumber;
-    transfer = ++blockNumber;
-    tempnum = ++blockNumber; // ++varCounter;
+    transfer = ++gd.context->blockNumber;
+    tempnum = ++gd.context->blockNumber; // ++varCounter;
     branch = gd.seqIndex == 0;
 }
 
@@ -603,14 +588,14 @@ void DecNode::genBlocks(BlockList & blocks, bool storeBlock)
 
 void EnumTypeNode::genBlocks(BlockList & blocks, bool storeBlock)
 {
-    name = "enum_values_" + str(++blockNumber);
+    name = "enum_values_" + str(++CompilationContext::current().blockNumber);
     for (ListIter it = values.begin(); it != values.end(); ++it)
         (*it)->genBlocks(blocks, storeBlock);
 }
 
 void EnumValueNode::genBlocks(BlockList & blocks, bool storeBlock)
 {
-    evmBlockNum = ++blockNumber;
+    evmBlockNum = ++CompilationContext::current().blockNumber;
 }
 
 void BoolNode::genBlocks(BlockList & blocks, bool storeBlock)
@@ -754,12 +739,12 @@ void NameNode::gen(GenData gd)
 {
     if (definingOccurrence)
     {
-        evmBlockNum = ++blockNumber;
-        varNum = ++blockNumber; // ++varCounter;
+        evmBlockNum = ++gd.context->blockNumber;
+        varNum = ++gd.context->blockNumber; // ++varCounter;
         owner = gd.entity;
         if (fieldNum < 0)
         {
-            fieldNum = fieldCounter++;
+            fieldNum = gd.context->fieldCounter++;
             //         cerr << value << " #" << fieldNum << endl; // 090207
             Node p = tie;
             while (p != this)
@@ -786,13 +771,13 @@ void NameNode::genBlocks(BlockList & blocks, bool storeBlock)
 
 void ThreadNode::gen(GenData gd)
 {
-    start = ++blockNumber;
-    fieldCounter = 0;
+    start = ++gd.context->blockNumber;
+    gd.context->fieldCounter = 0;
     for (ListIter it = inputs.begin(); it != inputs.end(); ++it)
         (*it)->gen(gd);
     for (ListIter it = outputs.begin(); it != outputs.end(); ++it)
         (*it)->gen(gd);
-    numFields = fieldCounter;
+    numFields = gd.context->fieldCounter;
     seq->gen(gd);
 }
 
@@ -814,7 +799,7 @@ void ThreadNode::genBlocks(BlockList &, bool storeBlock)
 
 void ThreadParamNode::gen(GenData gd)
 {
-    transfer = ++blockNumber;
+    transfer = ++gd.context->blockNumber;
     owner = gd.entity;
     name->gen(gd);
     type->gen(gd);
@@ -840,7 +825,7 @@ void ThreadParamNode::genBlocks(BlockList & blocks, bool storeBlock)
 
 void StartNode::gen(GenData gd)
 {
-    cerr << "090816 Generating Start node\n";
+    gd.context->diagnostics() << "090816 Generating Start node\n";
 
     for (ListIter it = calls.begin(); it != calls.end(); ++it)
         (*it)->gen(gd);
@@ -900,12 +885,12 @@ void ThreadCallNode::gen(GenData gd)
     chName = new NameNode(Errpos(), "ch", 0, true);
     chName->gen(gd);
     numFields = inputs.size() + outputs.size();
-    startTransfer = ++blockNumber;
-    inputTransfer = blockNumber + 1;
-    blockNumber += inputs.size();
-    outputTransfer = blockNumber + 1;
-    blockNumber += outputs.size();
-    stopTransfer = ++blockNumber;
+    startTransfer = ++gd.context->blockNumber;
+    inputTransfer = gd.context->blockNumber + 1;
+    gd.context->blockNumber += inputs.size();
+    outputTransfer = gd.context->blockNumber + 1;
+    gd.context->blockNumber += outputs.size();
+    stopTransfer = ++gd.context->blockNumber;
     name->gen(gd);
     for (ListIter it = inputs.begin(); it != inputs.end(); ++it)
         (*it)->gen(gd);
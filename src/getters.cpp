@@ -24,78 +24,83 @@ Node InstanceNode::getName() const
     return name;
 }
 
-//------------------------------------------------getNameString
+//------------------------------------------------getSymbol
 
-/** Return a string representation of the node's original name.  */
-string BaseNode::getNameString() const
+/** Return the node's original name.  */
+Symbol BaseNode::getSymbol() const
 {
-    emergencyStop("getNameString", ep);
-    return ""; // for VC7
+    emergencyStop("getSymbol", ep);
+    return Symbol(); // for VC7
+}
+
+const string & BaseNode::getNameString() const
+{
+    return getSymbol().str();
 }
 
-string DefNode::getNameString() const
+Symbol DefNode::getSymbol() const
 {
-    return value->getNameString();
+    return value->getSymbol();
 }
 
-string ProcedureNode::getNameString() const
+Symbol ProcedureNode::getSymbol() const
 {
     return name;
 }
 
-string ProcessNode::getNameString() const
+Symbol ProcessNode::getSymbol() const
 {
     return name;
 }
 
-string InstanceNode::getNameString() const
+Symbol InstanceNode::getSymbol() const
 {
-    return name->getNameString();
+    return name->getSymbol();
 }
 
-string DotNode::getNameString() const
+Symbol DotNode::getSymbol() const
 {
-    return port->getNameString();
+    return port->getSymbol();
 }
 
-string QueryNode::getNameString() const
+Symbol QueryNode::getSymbol() const
 {
-    return port->getNameString();
+    return port->getSymbol();
 }
 
-string DecNode::getNameString() const
+Symbol DecNode::getSymbol() const
 {
-    return name->getNameString();
+    return name->getSymbol();
 }
 
-string SubscriptNode::getNameString() const
+Symbol SubscriptNode::getSymbol() const
 {
-    return base->getNameString();
+    return base->getSymbol();
 }
 
-string EnumTypeNode::getNameString() const
+Symbol EnumTypeNode::getSymbol() const
 {
     return name;
 }
 
-string EnumValueNode::getNameString() const
+Symbol EnumValueNode::getSymbol() const
 {
     return name;
 }
 
-string NameNode::getNameString() const
+Symbol NameNode::getSymbol() const
 {
     return value;
 }
 
-string CharNode::getNameString() const
+Symbol CharNode::getSymbol() const
 {
-    return string(1, value);
+    return Symbol(string(1, value));
 }
 
-string TextNode::getNameString() const
+Symbol TextNode::getSymbol() const
 {
-    return value;
+    return Symbol(value);
 }
 
 //------------------------------------------------getType
@@ -656,7 +661,7 @@ string ThreadParamNode::getFullName(bool withpointer) const
 
 string NameNode::getFullName(bool withpointer) const
 {
-    return value + str(varNum);
+    return value.str() + str(varNum);
 }
 
 //------------------------------------------------getEType
@@ -1504,7 +1509,7 @@ string DecNode::getQueueTest() const
     if (name->kind() == DOT_NODE)
     {
         port = name->getPort();
-        if (port->getNameString() != BASIO_SYS)
+        if (port->getSymbol() != BASIO_SYS)
         {
             field = str(name->getFieldNum());
             if (value)
@@ -1528,7 +1533,7 @@ string DecNode::getQueueTest() const
     else if (value && value->kind() == DOT_NODE)
     {
         port = value->getPort();
-        if (port->getNameString() != BASIO_SYS)
+        if (port->getSymbol() != BASIO_SYS)
         {
             field = str(value->getFieldNum());
             kind = RECEIVING;
@@ -1,187 +1,741 @@
 #include "ast.h"
 #include "llvmgen.h"
 
+#include <llvm/Linker.h>
+#include <llvm/Support/FormattedStream.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/MutexGuard.h>
+#include <llvm/System/Host.h>
+#include <llvm/System/Path.h>
+#include <llvm/System/Process.h>
+#include <llvm/System/Program.h>
+#include <llvm/Target/TargetMachine.h>
+#include <llvm/Target/TargetRegistry.h>
+
+#include <glibmm.h>
+
+#include <cstdio>
 #include <iostream>
+#include <memory>
+#include <sstream>
 
-void BaseNode::genLLVM()
-{std::cout << "InstanceNode,LLVM \n";}
+LLVMData::LLVMData(LLVMContext & context, Module *module, bool debug)
+   : context(context), module(module), builder(context),
+     tiered(false), debugInfo(debug ? new DIFactory(*module) : 0)
+{}
 
-void ProgramNode::genLLVM()
+LLVMData::~LLVMData()
+{
+   delete debugInfo;
+}
+
+DICompileUnit LLVMData::compileUnit(int file, bool isMain)
+{
+   std::map<int, DICompileUnit>::const_iterator it = compileUnits.find(file);
+   if (it != compileUnits.end())
+      return it->second;
+   DICompileUnit unit =
+      debugInfo->CreateCompileUnit(dwarf::DW_LANG_lo_user,
+                                   CompilationContext::current().sources.fileName(file),
+                                   sys::Path::GetCurrentDirectory().str(), "mec", isMain);
+   compileUnits[file] = unit;
+   return unit;
+}
+
+void emitLocation(LLVMData & ld, const Errpos & ep, llvm::BasicBlock *bb)
+{
+   if (ld.debugInfo && ep.file != NO_FILE && ep.lineNum > 0)
+      ld.debugInfo->InsertStopPoint(ld.compileUnit(ep.file), ep.lineNum, ep.column() + 1, bb);
+}
+
+PerfMapListener::PerfMapListener()
+{
+   std::ostringstream fn;
+   fn << "/tmp/perf-" << sys::Process::GetCurrentProcessId() << ".map";
+   map.open(fn.str().c_str(), std::ios::app);
+}
+
+void PerfMapListener::NotifyFunctionEmitted(const Function & f, void *code, size_t size,
+                                            const EmittedFunctionDetails & details)
+{
+   map << std::hex << reinterpret_cast<unsigned long>(code) << ' ' << size << std::dec <<
+      ' ' << f.getName() << std::endl;
+}
+
+TieredJIT::TieredJIT(ExecutionEngine *engine, Module *module,
+                     FunctionPassManager *fpm, unsigned threshold)
+   : engine(engine), module(module), fpm(fpm), threshold(threshold),
+     thread(0), stopping(false)
+{
+   for (Module::iterator f = module->begin(); f != module->end(); ++f)
+   {
+      std::string name = f->getName();
+      if (name.compare(0, 8, "process.") != 0 || f->isDeclaration())
+         continue;
+      Tier tier;
+      tier.body = module->getFunction(name + ".body");
+      GlobalVariable *count = module->getGlobalVariable(name + ".count");
+      GlobalVariable *entry = module->getGlobalVariable(name + ".entry");
+      tier.hot = false;
+      if (!tier.body || !count || !entry)
+         continue;
+      // The watcher uses only these addresses, never the engine.
+      tier.count = static_cast<volatile unsigned*>(engine->getPointerToGlobal(count));
+      tier.entry = static_cast<volatile gpointer*>(engine->getPointerToGlobal(entry));
+      tiers.push_back(tier);
+   }
+}
+
+TieredJIT::~TieredJIT()
+{
+   stop();
+}
+
+void TieredJIT::start()
+{
+   if (!thread && !tiers.empty())
+      thread = Glib::Thread::create(sigc::mem_fun(*this, &TieredJIT::watch), true);
+}
+
+void TieredJIT::stop()
+{
+   if (!thread)
+      return;
+   {
+      Glib::Mutex::Lock lock(mutex);
+      stopping = true;
+   }
+   thread->join();
+   thread = 0;
+}
+
+void TieredJIT::watch()
+{
+   // The counters are read without synchronisation: a late or
+   // torn value only delays a promotion.
+   while (true)
+   {
+      {
+         Glib::Mutex::Lock lock(mutex);
+         if (stopping)
+            return;
+      }
+      for (std::vector<Tier>::iterator it = tiers.begin(); it != tiers.end(); ++it)
+         if (!it->hot && *it->count >= threshold)
+            promote(*it);
+      Glib::usleep(10000);
+   }
+}
+
+void TieredJIT::promote(Tier & tier)
+{
+   // Optimise a copy, so that the running code is never changed.
+   // The module and the engine are changed under the engine's lock,
+   // which the JIT holds whenever it compiles for the program.
+   void *code;
+   {
+      MutexGuard locked(engine->lock);
+      Function *hot = CloneFunction(tier.body);
+      hot->setName(tier.body->getName() + ".hot");
+      module->getFunctionList().push_back(hot);
+      fpm->run(*hot);
+      code = engine->getPointerToFunction(hot);
+   }
+   g_atomic_pointer_set(tier.entry, code);
+   tier.hot = true;
+}
+
+void linkRuntime(Module *module, const std::string & filename, bool availableExternally)
+{
+   std::string err;
+   MemoryBuffer *buffer = MemoryBuffer::getFile(filename.c_str(), &err);
+   if (!buffer)
+      Error() << "Failed to open '" << filename << "': " << err << "\n" << THROW;
+   Module *runtime = ParseBitcodeFile(buffer, module->getContext(), &err);
+   delete buffer;
+   if (!runtime)
+      Error() << "Failed to read '" << filename << "': " << err << "\n" << THROW;
+
+   // Saved code takes the library's variables and static constructors
+   // from libmert.a: the module only declares the variables, so that
+   // linking with the library neither defines them twice nor runs
+   // their constructors twice.
+   if (availableExternally)
+   {
+      if (GlobalVariable *ctors = runtime->getGlobalVariable("llvm.global_ctors", true))
+         ctors->eraseFromParent();
+      for (Module::global_iterator gv = runtime->global_begin(); gv != runtime->global_end(); ++gv)
+         if (gv->hasInitializer() && gv->getLinkage() == GlobalValue::ExternalLinkage)
+            gv->setInitializer(0);
+   }
+
+   // Remember what the library defines: the linker may rename local symbols.
+   std::vector<std::string> defined;
+   for (Module::iterator f = runtime->begin(); f != runtime->end(); ++f)
+      if (!f->isDeclaration() && f->getLinkage() == GlobalValue::ExternalLinkage)
+         defined.push_back(f->getName());
+
+   if (Linker::LinkModules(module, runtime, &err))
+      Error() << "Failed to link '" << filename << "': " << err << "\n" << THROW;
+   delete runtime;
+
+   if (availableExternally)
+      for (std::vector<std::string>::const_iterator it = defined.begin(); it != defined.end(); ++it)
+         if (Function *f = module->getFunction(*it))
+            f->setLinkage(GlobalValue::AvailableExternallyLinkage);
+}
+
+void optimizeModule(Module *module)
+{
+   PassManager pm;
+   pm.add(new TargetData(module));
+   pm.add(createFunctionInliningPass());
+   pm.add(createPromoteMemoryToRegisterPass());
+   pm.add(createInstructionCombiningPass());
+   pm.add(createReassociatePass());
+   pm.add(createGVNPass());
+   pm.add(createCFGSimplificationPass());
+   pm.add(createGlobalDCEPass());
+   pm.run(*module);
+}
+
+void optimizeLinked(Module *module)
+{
+   PassManager pm;
+   pm.add(new TargetData(module));
+   pm.add(createFunctionInliningPass());
+   pm.add(createInstructionCombiningPass());
+   pm.add(createCFGSimplificationPass());
+   pm.add(createGlobalDCEPass());
+   pm.run(*module);
+}
+
+void writeBitcode(Module *module, const std::string & filename)
+{
+   std::string err;
+   raw_fd_ostream os(filename.c_str(), err, raw_fd_ostream::F_Binary);
+   if (!err.empty())
+      Error() << "Failed to open '" << filename << "': " << err << "\n" << THROW;
+   WriteBitcodeToFile(module, os);
+   CompilationContext::current().diagnostics() << "Bitcode written to '" << filename << "'.\n";
+}
+
+void writeAssembly(Module *module, const std::string & filename)
+{
+   std::string err;
+   raw_fd_ostream os(filename.c_str(), err);
+   if (!err.empty())
+      Error() << "Failed to open '" << filename << "': " << err << "\n" << THROW;
+   module->print(os, 0);
+   CompilationContext::current().diagnostics() << "LLVM assembly written to '" << filename << "'.\n";
+}
+
+Module *loadCachedModule(const std::string & filename, LLVMContext & context)
+{
+   std::string err;
+   MemoryBuffer *buffer = MemoryBuffer::getFile(filename.c_str(), &err);
+   if (!buffer)
+      return 0;
+   // A damaged entry yields 0, and the program is compiled again.
+   Module *module = ParseBitcodeFile(buffer, context, &err);
+   delete buffer;
+   return module;
+}
+
+void storeCachedModule(Module *module, const std::string & filename)
+{
+   std::string err;
+   sys::Path dir(filename);
+   dir.eraseComponent();
+   if (dir.createDirectoryOnDisk(true, &err))
+   {
+      CompilationContext::current().diagnostics() << "Warning: cannot create '" << dir.str() << "': " << err << "\n";
+      return;
+   }
+
+   // Write under a private name and rename, so that another
+   // compiler never reads a partly written entry.
+   std::ostringstream tmp;
+   tmp << filename << '.' << sys::Process::GetCurrentProcessId();
+   {
+      raw_fd_ostream os(tmp.str().c_str(), err, raw_fd_ostream::F_Binary);
+      if (!err.empty())
+      {
+         CompilationContext::current().diagnostics() << "Warning: cannot write '" << tmp.str() << "': " << err << "\n";
+         return;
+      }
+      WriteBitcodeToFile(module, os);
+   }
+   if (std::rename(tmp.str().c_str(), filename.c_str()) != 0)
+      std::remove(tmp.str().c_str());
+}
+
+/** Generate native assembly for \a module with the host target machine,
+ *  then run the system assembler to obtain the object file.
+ */
+void writeObject(Module *module, const std::string & filename)
+{
+   InitializeAllAsmPrinters();
+
+   std::string triple = sys::getHostTriple();
+   std::string err;
+   const Target *target = TargetRegistry::lookupTarget(triple, err);
+   if (!target)
+      Error() << "No code generator for '" << triple << "': " << err << "\n" << THROW;
+   std::auto_ptr<TargetMachine> tm(target->createTargetMachine(triple, ""));
+   module->setTargetTriple(triple);
+
+   std::string asmfilename = filename.substr(0, filename.rfind('.')) + ".s";
+   {
+      raw_fd_ostream os(asmfilename.c_str(), err);
+      if (!err.empty())
+         Error() << "Failed to open '" << asmfilename << "': " << err << "\n" << THROW;
+      formatted_raw_ostream fos(os);
+
+      ExistingModuleProvider mp(module);
+      FunctionPassManager pm(&mp);
+      pm.add(new TargetData(*tm->getTargetData()));
+      if (tm->addPassesToEmitFile(pm, fos, TargetMachine::AssemblyFile, CodeGenOpt::Default) != FileModel::AsmFile ||
+          tm->addPassesToEmitFileFinish(pm, (ObjectCodeEmitter *)0, CodeGenOpt::Default))
+      {
+         mp.releaseModule();
+         Error() << "Target '" << triple << "' cannot emit assembly.\n" << THROW;
+      }
+      pm.doInitialization();
+      for (Module::iterator f = module->begin(); f != module->end(); ++f)
+         if (!f->isDeclaration())
+            pm.run(*f);
+      pm.doFinalization();
+
+      // The module belongs to the caller.
+      mp.releaseModule();
+   }
+
+   sys::Path as = sys::Program::FindProgramByName("as");
+   if (as.isEmpty())
+      Error() << "No assembler found to build '" << filename << "'.\n" << THROW;
+   const char *args[] = { "as", "-o", filename.c_str(), asmfilename.c_str(), 0 };
+   if (sys::Program::ExecuteAndWait(as, args, 0, 0, 0, 0, &err) != 0)
+      Error() << "Failed to assemble '" << asmfilename << "': " << err << "\n" << THROW;
+   sys::Path(asmfilename).eraseFromDisk();
+   CompilationContext::current().diagnostics() << "Object written to '" << filename << "'.\n";
+}
+
+void BaseNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "InstanceNode,LLVM \n";}
+
+/** A process type or procedure, which is generated and optimised
+ *  in a module and context of its own and then linked into the program.
+ */
+struct CodeUnit
+{
+   CodeUnit(Node def, const LLVMData & ld)
+      : def(def), context(&CompilationContext::current()),
+        debug(ld.debugInfo != 0), tiered(ld.tiered), failed(false)
+   {
+      std::map<int, std::string>::const_iterator it = ld.cacheEntries.find(def->getPos().file);
+      if (it != ld.cacheEntries.end())
+         cacheFile = it->second + "." + def->getNameString() + ".bc";
+   }
+
+   /** The definition of the process type or procedure. */
+   Node def;
+
+   /** The compilation that the unit belongs to. */
+   CompilationContext *context;
+
+   /** Generate debug information. */
+   bool debug;
+
+   /** Generate for tiered execution. */
+   bool tiered;
+
+   /** Code cache entry for the unit, or empty if it is not cached. */
+   std::string cacheFile;
+
+   /** The optimised module, as bitcode. */
+   std::string bitcode;
+
+   /** Set if generation failed; \a message says why. */
+   bool failed;
+   Glib::ustring message;
+};
+
+/** Generate and optimise one unit.  This runs on a worker thread,
+ *  so it uses nothing that is shared with other units.
+ */
+static void genUnit(CodeUnit *unit)
+{
+   CompilationContext::setCurrent(unit->context);
+
+   try
+   {
+      LLVMContext context;
+
+      // The module that defines the unit has not changed since the
+      // entry was stored: its code can be used as it is.  An entry
+      // that cannot be read is removed, and the unit generated again.
+      if (!unit->cacheFile.empty())
+         if (MemoryBuffer *buffer = MemoryBuffer::getFile(unit->cacheFile.c_str()))
+         {
+            std::string err;
+            Module *cached = ParseBitcodeFile(buffer, context, &err);
+            bool valid = cached != 0;
+            if (valid)
+               unit->bitcode.assign(buffer->getBufferStart(), buffer->getBufferSize());
+            delete cached;
+            delete buffer;
+            if (valid)
+               return;
+            std::remove(unit->cacheFile.c_str());
+         }
+
+      Module module(unit->def->getNameString(), context);
+      {
+         LLVMData ld(context, &module, unit->debug);
+         ld.tiered = unit->tiered;
+         unit->def->genLLVM(ld);
+      }
+      // Tiered code starts unoptimised: TieredJIT optimises what is hot.
+      if (!unit->tiered)
+         optimizeModule(&module);
+      if (!unit->cacheFile.empty())
+         storeCachedModule(&module, unit->cacheFile);
+      raw_string_ostream os(unit->bitcode);
+      WriteBitcodeToFile(&module, os);
+      os.flush();
+   }
+   catch (const Glib::ustring & msg)
+   {
+      unit->failed = true;
+      unit->message = msg;
+   }
+}
+
+/** Generate \a units in parallel, then link them, in order, into the module of \a ld. */
+static void genUnits(std::vector<CodeUnit*> & units, LLVMData & ld)
+{
+   unsigned workers = CompilationContext::current().workers();
+   if (llvm_is_multithreaded() && units.size() > 1 && workers > 1)
+   {
+      Glib::ThreadPool pool(workers);
+      for (std::vector<CodeUnit*>::iterator it = units.begin(); it != units.end(); ++it)
+         pool.push(sigc::bind(sigc::ptr_fun(&genUnit), *it));
+      pool.shutdown();
+   }
+   else
+      for (std::vector<CodeUnit*>::iterator it = units.begin(); it != units.end(); ++it)
+         genUnit(*it);
+
+   // Bitcode carries each module from its own context into the program's.
+   Glib::ustring message;
+   for (std::vector<CodeUnit*>::iterator it = units.begin(); it != units.end(); ++it)
+   {
+      CodeUnit *unit = *it;
+      if (unit->failed)
+      {
+         if (message.empty())
+            message = unit->message;
+      }
+      else if (message.empty())
+      {
+         std::string err;
+         MemoryBuffer *buffer = MemoryBuffer::getMemBuffer(unit->bitcode.c_str(),
+                                                           unit->bitcode.c_str() + unit->bitcode.size());
+         Module *module = ParseBitcodeFile(buffer, ld.context, &err);
+         delete buffer;
+         if (!module)
+            message = "Failed to read code for '" + unit->def->getNameString() + "': " + err;
+         else
+         {
+            if (Linker::LinkModules(ld.module, module, &err))
+               message = "Failed to link code for '" + unit->def->getNameString() + "': " + err;
+            delete module;
+         }
+      }
+      delete unit;
+   }
+   units.clear();
+   if (!message.empty())
+      throw message;
+}
+
+void ProgramNode::genLLVM(LLVMData & ld)
 {   
-   std::cout << "LLVM Code generation\n";
+   CompilationContext::current().diagnostics() << "LLVM Code generation\n";
    //prolog();
+
+   // After genBlocks, each process type and procedure is independent
+   // of the others, so they are generated concurrently.
+   std::vector<CodeUnit*> units;
    for (ListIter it = nodes.begin(); it != nodes.end(); ++it)
-      (*it)->genLLVM();
+   {
+      Node value = (*it)->kind() == DEF_NODE ? (*it)->getValue() : 0;
+      if (value && (value->kind() == PROCESS_NODE || value->kind() == PROCEDURE_NODE))
+         units.push_back(new CodeUnit(*it, ld));
+      else
+         (*it)->genLLVM(ld);
+   }
+   genUnits(units, ld);
    //epilog();
    //showCode();
+
+   // Entry point: create the top-level processes, then hand control
+   // to the scheduler in the run-time library.
+   const Type *intTy = Type::getInt32Ty(ld.context);
+   const Type *charPtrTy = PointerType::getUnqual(Type::getInt8Ty(ld.context));
+   std::vector<const Type*> args(1, charPtrTy);
+   const Type *activateTy = PointerType::getUnqual(FunctionType::get(intTy, args, false));
+   Constant *spawn = ld.module->getOrInsertFunction("mert_spawn", Type::getVoidTy(ld.context),
+                                                    charPtrTy, activateTy, NULL);
+   Constant *run = ld.module->getOrInsertFunction("mert_run", intTy, NULL);
+   Function *entry = Function::Create(FunctionType::get(intTy, false),
+                                      Function::ExternalLinkage, "main", ld.module);
+   ld.builder.SetInsertPoint(llvm::BasicBlock::Create(ld.context, "entry", entry));
+   for (ListIter it = nodes.begin(); it != nodes.end(); ++it)
+   {
+      if ((*it)->kind() != INSTANCE_NODE ||
+          (*it)->getName()->getDefinition()->getValue()->kind() != PROCESS_NODE)
+         continue;
+      const std::string & name = (*it)->getNameString();
+      const Type *textTy = ArrayType::get(Type::getInt8Ty(ld.context), name.size() + 1);
+      GlobalVariable *text = new GlobalVariable(*ld.module, textTy, true, GlobalValue::InternalLinkage,
+                                                ConstantArray::get(ld.context, name), "name." + name);
+      ld.builder.CreateCall2(spawn, ld.builder.CreateConstGEP2_32(text, 0, 0),
+                             ld.module->getFunction("process." + name));
+   }
+   ld.builder.CreateRet(ld.builder.CreateCall(run));
 }
 
-void InstanceNode::genLLVM()
-{std::cout << "InstanceNode,LLVM \n";}
+void InstanceNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "InstanceNode,LLVM \n";}
 
-void RemoveNode::genLLVM()
-{std::cout << "Remove,LLVM \n";}
+void RemoveNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "Remove,LLVM \n";}
 
-void ProcessNode::genLLVM()
+void ProcessNode::genLLVM(LLVMData & ld)
 {
- std::cout << "ProcessNode,LLVM \n";
+ CompilationContext::current().diagnostics() << "ProcessNode,LLVM \n";
  for (ListIter it = params.begin(); it != params.end(); ++it)
-    (*it)->genLLVM();
+    (*it)->genLLVM(ld);
+
+ const std::string & name = this->name.str();
+
+ // A process is activated through 'i32 process.<name>(i8 *self)',
+ // which runs it to its next unlock point and returns nonzero if it
+ // is to be activated again (see CompiledProcess in the prelude).
+ // For tiered execution that function only dispatches, and the body
+ // is 'process.<name>.body'.  Profilers and debuggers see the body
+ // under the name of the process.
+ const Type *intTy = Type::getInt32Ty(ld.context);
+ std::vector<const Type*> args(1, PointerType::getUnqual(Type::getInt8Ty(ld.context)));
+ const FunctionType *bodyTy = FunctionType::get(intTy, args, false);
+ Function *body = Function::Create(bodyTy, Function::ExternalLinkage,
+                                   "process." + name + (ld.tiered ? ".body" : ""), ld.module);
+ llvm::BasicBlock *entry = llvm::BasicBlock::Create(ld.context, "entry", body);
+ DISubprogram sp;
+ if (ld.debugInfo)
+ {
+    DICompileUnit unit = ld.compileUnit(ep.file);
+    sp = ld.debugInfo->CreateSubprogram(unit, name, name, body->getName(),
+                                        unit, ep.lineNum, DIType(), false, true);
+    ld.debugInfo->InsertSubprogramStart(sp, entry);
+ }
+ emitLocation(ld, ep, entry);
+ ld.builder.SetInsertPoint(entry);
+ seq->genLLVM(ld);
+ if (ld.debugInfo)
+    ld.debugInfo->InsertRegionEnd(sp, ld.builder.GetInsertBlock());
+ // The statements generate no code yet, so the process finishes
+ // in its first activation.
+ ld.builder.CreateRet(ConstantInt::get(intTy, 0));
+
+ if (ld.tiered)
+ {
+    // Activation counter and dispatch slot for TieredJIT.  The
+    // dispatcher counts the activation, then loads the slot and calls
+    // whatever body it holds.  An activation runs to the next unlock
+    // point, so a promoted body takes over at that point.
+    const Type *countTy = Type::getInt32Ty(ld.context);
+    GlobalVariable *count = new GlobalVariable(*ld.module, countTy, false,
+                                               GlobalValue::ExternalLinkage,
+                                               ConstantInt::get(countTy, 0),
+                                               "process." + name + ".count");
+    GlobalVariable *slot = new GlobalVariable(*ld.module, body->getType(), false,
+                                              GlobalValue::ExternalLinkage,
+                                              body, "process." + name + ".entry");
+    Function *dispatch = Function::Create(bodyTy, Function::ExternalLinkage,
+                                          "process." + name, ld.module);
+    ld.builder.SetInsertPoint(llvm::BasicBlock::Create(ld.context, "entry", dispatch));
+    ld.builder.CreateStore(ld.builder.CreateAdd(ld.builder.CreateLoad(count),
+                                                ConstantInt::get(countTy, 1)), count);
+    // Volatile: the slot is changed by TieredJIT while the program runs.
+    Value *target = ld.builder.CreateLoad(slot, true);
+    ld.builder.CreateRet(ld.builder.CreateCall(target, dispatch->arg_begin()));
+ }
 }
 
-void CppNode::genLLVM()  
-{std::cout << "CppNode,LLVM \n";}
+void CppNode::genLLVM(LLVMData & ld)  
+{CompilationContext::current().diagnostics() << "CppNode,LLVM \n";}
 
-void ProcedureNode::genLLVM()    
-{std::cout << "ProcedureNode,LLVM \n";}
+void ProcedureNode::genLLVM(LLVMData & ld)    
+{CompilationContext::current().diagnostics() << "ProcedureNode,LLVM \n";}
 
-void ProtocolNode::genLLVM()
-{std::cout << "ProtocolNode,LLVM \n";}
+void ProtocolNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "ProtocolNode,LLVM \n";}
 
-void DefNode::genLLVM()
+void DefNode::genLLVM(LLVMData & ld)
 {
-	std::cout << "DefNode,LLVM \n";
-	name->genLLVM();
-	value->genLLVM();
+	CompilationContext::current().diagnostics() << "DefNode,LLVM \n";
+	name->genLLVM(ld);
+	value->genLLVM(ld);
 }
 
-void CellNode::genLLVM()
-{std::cout << "CellNode,LLVM \n";}
+void CellNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "CellNode,LLVM \n";}
 
-void SequenceNode::genLLVM()
-{std::cout << "SequenceNode,LLVM \n";}
+void SequenceNode::genLLVM(LLVMData & ld)
+{
+   CompilationContext::current().diagnostics() << "SequenceNode,LLVM \n";
+   // A stoppoint before each statement, so that a debugger steps by statement.
+   for (ListIter it = stmts.begin(); it != stmts.end(); ++it)
+   {
+      emitLocation(ld, (*it)->getPos(), ld.builder.GetInsertBlock());
+      (*it)->genLLVM(ld);
+   }
+}
 
-void SkipNode::genLLVM()
-{std::cout << "SkipNode,LLVM \n";}
+void SkipNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "SkipNode,LLVM \n";}
 
-void ExitNode::genLLVM()
-{std::cout << "ExitNode,LLVM \n";}
+void ExitNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "ExitNode,LLVM \n";}
 
-void IfNode::genLLVM()
-{std::cout << "IfNode,LLVM \n";}
+void IfNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "IfNode,LLVM \n";}
 
-void CondPairNode::genLLVM()
-{std::cout << "CondPairNode,LLVM \n";}
+void CondPairNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "CondPairNode,LLVM \n";}
 
-void LoopNode::genLLVM()
-{std::cout << "LoopNode,LLVM \n";}
+void LoopNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "LoopNode,LLVM \n";}
 
-void ForNode::genLLVM()
+void ForNode::genLLVM(LLVMData & ld)
 {
-	comp->genLLVM();
-	seq->genLLVM();
-	std::cout << "ForNode,LLVM \n";
+	comp->genLLVM(ld);
+	seq->genLLVM(ld);
+	CompilationContext::current().diagnostics() << "ForNode,LLVM \n";
 	
 }
 
-void AnyNode::genLLVM()
+void AnyNode::genLLVM(LLVMData & ld)
 {	
-	comp->genLLVM();
-	seq->genLLVM();
-	std::cout << "AnyNode,LLVM \n";
+	comp->genLLVM(ld);
+	seq->genLLVM(ld);
+	CompilationContext::current().diagnostics() << "AnyNode,LLVM \n";
 }
 
-void ComprehensionNode::genLLVM()
+void ComprehensionNode::genLLVM(LLVMData & ld)
 {
 	  //drawSubTree(os, type, nodeNums, level + 2);
-      var->genLLVM();
-      collection->genLLVM();
+      var->genLLVM(ld);
+      collection->genLLVM(ld);
       //drawSubTree(os, pred, nodeNums, level + 2);
-	  std::cout << "ComprehensionNode,LLVM \n";
+	  CompilationContext::current().diagnostics() << "ComprehensionNode,LLVM \n";
 }
 
-void RangeNode::genLLVM()
-{std::cout << "RangeNode,LLVM \n";}
+void RangeNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "RangeNode,LLVM \n";}
 
-void RangeInitNode::genLLVM()
+void RangeInitNode::genLLVM(LLVMData & ld)
 {      
-	  var->genLLVM();
-      start->genLLVM();
-      finish->genLLVM();
-	  std::cout << "RangeInitNode,LLVM \n";
+	  var->genLLVM(ld);
+      start->genLLVM(ld);
+      finish->genLLVM(ld);
+	  CompilationContext::current().diagnostics() << "RangeInitNode,LLVM \n";
 }
 
-void RangeTermNode::genLLVM()
-{std::cout << "RangeTermNode,LLVM \n";}
+void RangeTermNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "RangeTermNode,LLVM \n";}
 
-void RangeStepNode::genLLVM()
-{std::cout << "RangeStepNode,LLVM \n";}
+void RangeStepNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "RangeStepNode,LLVM \n";}
 
-void MapSetNode::genLLVM()
-{std::cout << "MapSetNode,LLVM \n";}
+void MapSetNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "MapSetNode,LLVM \n";}
 
-void MapInitNode::genLLVM()
-{std::cout << "MapInitNode,LLVM \n";}
+void MapInitNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "MapInitNode,LLVM \n";}
 
-void MapTermNode::genLLVM()
-{std::cout << "MapTermNode,LLVM \n";}
+void MapTermNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "MapTermNode,LLVM \n";}
 
-void MapStepNode::genLLVM()
-{std::cout << "MapStepNode,LLVM \n";}
+void MapStepNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "MapStepNode,LLVM \n";}
 
-void EnumSetNode::genLLVM()
-{std::cout << "EnumSetNode,LLVM \n";}
+void EnumSetNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "EnumSetNode,LLVM \n";}
 
-void EnumInitNode::genLLVM()
-{std::cout << "EnumInitNode,LLVM \n";}
+void EnumInitNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "EnumInitNode,LLVM \n";}
 
-void EnumTermNode::genLLVM()
-{std::cout << "EnumTermNode,LLVM \n";}
+void EnumTermNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "EnumTermNode,LLVM \n";}
 
-void EnumStepNode::genLLVM()
-{std::cout << "EnumStepNode,LLVM \n";}
+void EnumStepNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "EnumStepNode,LLVM \n";}
 
-void MatchNode::genLLVM()
-{std::cout << "MatchNode,LLVM \n";}
+void MatchNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "MatchNode,LLVM \n";}
 
-void SelectNode::genLLVM()
-{std::cout << "SelectNode,LLVM \n";}
+void SelectNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "SelectNode,LLVM \n";}
 
-void OptionNode::genLLVM()
-{std::cout << "OptionNode,LLVM \n";}
+void OptionNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "OptionNode,LLVM \n";}
 
-void DotNode::genLLVM()
-{std::cout << "DotNode,LLVM \n";}
+void DotNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "DotNode,LLVM \n";}
 
-void QueryNode::genLLVM()
-{std::cout << "QueryNode,LLVM \n";}
+void QueryNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "QueryNode,LLVM \n";}
 
-void BoolNode::genLLVM()
-{std::cout << "BoolNode,LLVM \n";}
+void BoolNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "BoolNode,LLVM \n";}
 
-void CharNode::genLLVM()
-{std::cout << "CharNode,LLVM \n";}
+void CharNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "CharNode,LLVM \n";}
 
-void TextNode::genLLVM()
-{std::cout << "TextNode,LLVM \n";}
+void TextNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "TextNode,LLVM \n";}
 
-void NumNode::genLLVM()
-{std::cout << "NumNode,LLVM \n";}
+void NumNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "NumNode,LLVM \n";}
 
-void ListopNode::genLLVM()
-{std::cout << "ListopNode,LLVM \n";}
+void ListopNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "ListopNode,LLVM \n";}
 
-void BinopNode::genLLVM()
-{std::cout << "BinopNode,LLVM \n";}
+void BinopNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "BinopNode,LLVM \n";}
 
-void CondExprNode::genLLVM()
-{std::cout << "CondExprNode,LLVM \n";}
+void CondExprNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "CondExprNode,LLVM \n";}
 
-void UnopNode::genLLVM()
-{std::cout << "UnopNode,LLVM \n";}
+void UnopNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "UnopNode,LLVM \n";}
 
-void SubscriptNode::genLLVM()
-{std::cout << "SubscriptNode,LLVM \n";}
+void SubscriptNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "SubscriptNode,LLVM \n";}
 
-void SubrangeNode::genLLVM()
-{std::cout << "SubrangeNode,LLVM \n";}
+void SubrangeNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "SubrangeNode,LLVM \n";}
 
-void IteratorNode::genLLVM()
-{std::cout << "IteratorNode,LLVM \n";}
+void IteratorNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "IteratorNode,LLVM \n";}
 
-void ConstantNode::genLLVM()
+void ConstantNode::genLLVM(LLVMData & ld)
 {
-  std::cout << "ConstantNode,LLVM \n";
+  CompilationContext::current().diagnostics() << "ConstantNode,LLVM \n";
   //Not compiling
 //  std::string Name = name->getValue();
 //  Value *V = NamedValues[Name];
@@ -190,53 +744,53 @@ void ConstantNode::genLLVM()
 
 }
 
-void DecNode::genLLVM()
-{std::cout << "DecNode,LLVM \n";}
+void DecNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "DecNode,LLVM \n";}
 
-void EnumValueNode::genLLVM()
-{std::cout << "EnumValueNode,LLVM \n";}
+void EnumValueNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "EnumValueNode,LLVM \n";}
 
-void ArrayTypeNode::genLLVM()
-{std::cout << "ArrayTypeNode,LLVM \n";}
+void ArrayTypeNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "ArrayTypeNode,LLVM \n";}
 
-void MapTypeNode::genLLVM()
-{std::cout << "MapTypeNode,LLVM \n";}
+void MapTypeNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "MapTypeNode,LLVM \n";}
 
-void IterTypeNode::genLLVM()
-{std::cout << "IterTypeNode,LLVM \n";}
+void IterTypeNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "IterTypeNode,LLVM \n";}
 
-void FunctionNode::genLLVM()
-{std::cout << "FunctionNode,LLVM \n";}
+void FunctionNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "FunctionNode,LLVM \n";}
 
-void NameNode::genLLVM()
-{std::cout << "NameNode,LLVM \n";}
+void NameNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "NameNode,LLVM \n";}
 
-void SendNode::genLLVM()
-{std::cout << "SendNode,LLVM \n";}
+void SendNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "SendNode,LLVM \n";}
 
-void SendOptionNode::genLLVM()
-{std::cout << "SendOptionNode,LLVM \n";}
+void SendOptionNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "SendOptionNode,LLVM \n";}
 
-void ReceiveNode::genLLVM()
-{std::cout << "ReceiveNode,LLVM \n";}
+void ReceiveNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "ReceiveNode,LLVM \n";}
 
-void ReceiveOptionNode::genLLVM()
-{std::cout << "ReceiveOptionNode,LLVM \n";}
+void ReceiveOptionNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "ReceiveOptionNode,LLVM \n";}
 
-void ThreadNode::genLLVM()
-{std::cout << "ThreadNode,LLVM \n";}
+void ThreadNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "ThreadNode,LLVM \n";}
 
-void ThreadParamNode::genLLVM()
-{std::cout << "ThreadParamNode,LLVM \n";}
+void ThreadParamNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "ThreadParamNode,LLVM \n";}
 
-void StartNode::genLLVM()
-{std::cout << "StartNode,LLVM \n";}
+void StartNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "StartNode,LLVM \n";}
 
-void ThreadCallNode::genLLVM()
-{std::cout << "ThreadCallNode,LLVM \n";}
+void ThreadCallNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "ThreadCallNode,LLVM \n";}
 
-void ThreadStartNode::genLLVM()
-{std::cout << "ThreadStartNode,LLVM \n";}
+void ThreadStartNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "ThreadStartNode,LLVM \n";}
 
-void ThreadStopNode::genLLVM()
-{std::cout << "ThreadStopNode,LLVM \n";}
+void ThreadStopNode::genLLVM(LLVMData & ld)
+{CompilationContext::current().diagnostics() << "ThreadStopNode,LLVM \n";}
@@ -1,7 +1,12 @@
 #ifndef LLVMGEN_H
 #define LLVMGEN_H
 
+#include "error.h"
+
+#include <glibmm.h>
+
 #include <stack>
+#include <fstream>
 #include <llvm/Module.h>
 #include <llvm/Function.h>
 #include <llvm/Type.h>
@@ -18,6 +23,8 @@
 #include <llvm/Target/TargetSelect.h>
 #include <llvm/ExecutionEngine/GenericValue.h>
 #include <llvm/ExecutionEngine/JIT.h>
+#include <llvm/ExecutionEngine/JITEventListener.h>
+#include <llvm/Analysis/DebugInfo.h>
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/Value.h>
 
@@ -27,16 +34,74 @@
 #include <llvm/Analysis/Verifier.h>
 #include <llvm/Target/TargetData.h>
 #include <llvm/Transforms/Scalar.h>
+#include <llvm/Transforms/IPO.h>
 #include <llvm/Support/IRBuilder.h>
 
 using namespace llvm;
 
 
+/** An instance is passed around the AST during LLVM code generation.
+ *  It holds everything that belongs to one module, so that
+ *  independent parts of a program can be generated concurrently,
+ *  each with a context of its own.
+ */
+class LLVMData
+{
+   public:
+      /** Construct for generating code into \a module, which belongs to \a context.
+       *  If \a debug is set, debug information is generated.
+       */
+      LLVMData(LLVMContext & context, Module *module, bool debug = false);
+
+      /** \return the compile unit for debug information about the
+       *  source file numbered \a file, creating it if necessary.
+       *  \param isMain marks the unit of the main file of the program:
+       *         only the module of the whole program has one.
+       */
+      DICompileUnit compileUnit(int file, bool isMain = false);
+
+      /** Delete the debug information factory. */
+      ~LLVMData();
+
+      /** Context that owns the types and constants of the module. */
+      LLVMContext & context;
+
+      /** Module that receives the generated code. */
+      Module *module;
+
+      /** Instruction builder for the module. */
+      IRBuilder<> builder;
+
+      /** Local variables of the function being generated. */
+      std::map<std::string, AllocaInst*> namedValues;
+
+      /** Generate for tiered execution (+R): leave the code unoptimised,
+       *  and activate each process type through a dispatcher that
+       *  counts its activations and calls the body through a dispatch
+       *  slot (see TieredJIT).
+       */
+      bool tiered;
+
+      /** Debug information for the module, or 0 if none is wanted. */
+      DIFactory *debugInfo;
 
-static Module *TheModule;
-static IRBuilder<> Builder(getGlobalContext());
-static std::map<std::string, AllocaInst*> NamedValues;
-static FunctionPassManager *TheFPM;
+      /** Compile units for debug information in the module, by file number. */
+      std::map<int, DICompileUnit> compileUnits;
+
+      /** Code cache entries of the source files, by file number.
+       *  Each entry is a path prefix: the code of a process type or
+       *  procedure defined in the file is cached in '<prefix>.<name>.bc'.
+       *  Files without an entry, and all files if the map is empty,
+       *  are always compiled.
+       */
+      std::map<int, std::string> cacheEntries;
+
+   private:
+
+      // Not copyable: the builder and the factory belong to the module.
+      LLVMData(const LLVMData &);
+      void operator=(const LLVMData &);
+};
 
 /// CreateEntryBlockAlloca - Create an alloca instruction in the entry block of
 /// the function.  This is used for mutable variables etc.
@@ -44,15 +109,147 @@ static AllocaInst *CreateEntryBlockAlloca(Function *TheFunction,
                                           const std::string &VarName) {
   IRBuilder<> TmpB(&TheFunction->getEntryBlock(),
                  TheFunction->getEntryBlock().begin());
-  return TmpB.CreateAlloca(Type::getDoubleTy(getGlobalContext()), 0,
+  return TmpB.CreateAlloca(Type::getDoubleTy(TheFunction->getContext()), 0,
                            VarName.c_str());
 }
 
-static ExecutionEngine *TheExecutionEngine;
-
 static void MainLoop() {
 }
 
+/** Attach the source position \a ep to the end of \a bb
+ *  as a DWARF line record, in the compile unit of its file.
+ *  Does nothing without debug information.
+ */
+void emitLocation(LLVMData & ld, const Errpos & ep, llvm::BasicBlock *bb);
+
+/** An instance writes an entry in /tmp/perf-<pid>.map for each function
+ *  that the JIT compiles.  Linux 'perf' reads this file to name code
+ *  that does not belong to an object file.
+ */
+class PerfMapListener : public JITEventListener
+{
+   public:
+
+      /** Open (or continue) the map file of this process. */
+      PerfMapListener();
+
+      /** Write "<start> <size> <name>" for a compiled function. */
+      void NotifyFunctionEmitted(const Function & f, void *code, size_t size,
+                                 const EmittedFunctionDetails & details);
+
+   private:
+
+      /** The map file. */
+      std::ofstream map;
+};
+
+/** An instance runs a program in tiers.  The program starts in code
+ *  that is JIT-compiled without optimisation.  The scheduler activates
+ *  a process through the dispatcher 'process.<name>', which counts
+ *  the activation in the global 'process.<name>.count', loads the
+ *  dispatch slot 'process.<name>.entry' and calls the body it holds,
+ *  at first 'process.<name>.body'.  A background thread watches the
+ *  counters; when a process type becomes hot, it optimises a copy of
+ *  the body, compiles it and stores its address in the slot.
+ *
+ *  An activation runs a process from one unlock point to the next, so
+ *  a counter counts the blocks between unlock points that the process
+ *  type has run, not the basic blocks within them, and a process
+ *  switches to the new code at its next unlock point.  A process that
+ *  loops without reaching an unlock point stays in the old code.
+ */
+class TieredJIT
+{
+   public:
+
+      /** Construct for the process types in \a module, which \a engine runs.
+       *  \param fpm optimises hot process bodies.
+       *  \param threshold is the number of activations that makes a process type hot.
+       */
+      TieredJIT(ExecutionEngine *engine, Module *module,
+                FunctionPassManager *fpm, unsigned threshold);
+
+      /** Stop the background thread. */
+      ~TieredJIT();
+
+      /** Start watching the counters. */
+      void start();
+
+      /** Stop watching the counters and wait for the thread to finish. */
+      void stop();
+
+   private:
+
+      /** The state of one process type. */
+      struct Tier
+      {
+         Function *body;
+         volatile unsigned *count;
+         volatile gpointer *entry;
+         bool hot;
+      };
+
+      /** Body of the background thread. */
+      void watch();
+
+      /** Optimise and compile the body of \a tier, then publish it. */
+      void promote(Tier & tier);
+
+      ExecutionEngine *engine;
+      Module *module;
+      FunctionPassManager *fpm;
+      unsigned threshold;
+      std::vector<Tier> tiers;
+      Glib::Thread *thread;
+      Glib::Mutex mutex;
+      bool stopping;
+
+      // Not copyable.
+      TieredJIT(const TieredJIT &);
+      void operator=(const TieredJIT &);
+};
+
+/** Link the run-time library (mert.bc) into \a module.
+ *  \param filename is the path of the bitcode library.
+ *  \param availableExternally marks the library functions
+ *         'available_externally' and keeps only declarations of its
+ *         variables and none of its static constructors: functions can
+ *         be inlined, but everything else is resolved against libmert.a
+ *         when the code is linked.
+ */
+void linkRuntime(Module *module, const std::string & filename, bool availableExternally);
+
+/** Inline run-time helpers and optimise every function in \a module. */
+void optimizeModule(Module *module);
+
+/** Finish optimising a program whose parts were optimised separately
+ *  by optimizeModule(): inline the run-time helpers that were linked
+ *  afterwards and remove unused definitions.
+ */
+void optimizeLinked(Module *module);
+
+/** Write \a module to \a filename as LLVM bitcode (.bc). */
+void writeBitcode(Module *module, const std::string & filename);
+
+/** Write \a module to \a filename as LLVM assembly text (.ll). */
+void writeAssembly(Module *module, const std::string & filename);
+
+/** Compile \a module for the host and write a native object file (.o).
+ *  The object refers to the scheduler and helpers in the run-time
+ *  library (libmert.a), which must be given to the linker.
+ */
+void writeObject(Module *module, const std::string & filename);
+
+/** Read a module from the code cache entry \a filename into \a context.
+ *  \return the module, or 0 if there is no usable entry.
+ */
+Module *loadCachedModule(const std::string & filename, LLVMContext & context);
+
+/** Store \a module in the code cache entry \a filename.
+ *  Failure is reported as a warning: the cache is only an optimisation.
+ */
+void storeCachedModule(Module *module, const std::string & filename);
+
 
 #endif
 
@@ -1,32 +1,33 @@
 /** \file lookup.cpp */
 
 #include "ast.h"
+#include "scope.h"
 
-/** If the node has a name with string value, return a pointer to it.
+/** If the node has the name \a value, return a pointer to it.
  * This function works differently for variables names defined in
  * a definition or declaration (which consists of a name/value pair)
  * and protocols (where the field declaration may be nested in an
  * expression).
  */
-Node BaseNode::lookUp(string value, Errpos ep)
+Node BaseNode::lookUp(Symbol value, Errpos ep)
 {
     showDebug("Sorry!  Compiler error in lookUp.");
     Error() << "'" << value << "' undefined in this context." << ep << REPORT;
 }
 
-Node InstanceNode::lookUp(string value, Errpos ep)
+Node InstanceNode::lookUp(Symbol value, Errpos ep)
 {
     return defChain->lookUp(value, ep);
 }
 
-Node ProtocolNode::lookUp(string value, Errpos ep)
+Node ProtocolNode::lookUp(Symbol value, Errpos ep)
 {
     return expr->lookUp(value, ep);
 }
 
-Node DefNode::lookUp(string str, Errpos ep)
+Node DefNode::lookUp(Symbol str, Errpos ep)
 {
-    if (name->getNameString() == str)
+    if (name->getSymbol() == str)
         return this;
 
     // The next step is needed for definitions that contain names,
@@ -37,76 +38,76 @@ Node DefNode::lookUp(string str, Errpos ep)
         return 0;
 }
 
-Node SequenceNode::lookUp(string value, Errpos ep)
+Node SequenceNode::lookUp(Symbol value, Errpos ep)
 {
     assert(defChain != this);
     return defChain->lookUp(value, ep);
 }
 
-Node ExitNode::lookUp(string value, Errpos ep)
+Node ExitNode::lookUp(Symbol value, Errpos ep)
 {
     return defChain->lookUp(value, ep);
 }
 
-Node IfNode::lookUp(string value, Errpos ep)
+Node IfNode::lookUp(Symbol value, Errpos ep)
 {
     return defChain->lookUp(value, ep);
 }
 
-Node CondPairNode::lookUp(string value, Errpos ep)
+Node CondPairNode::lookUp(Symbol value, Errpos ep)
 {
     return defChain->lookUp(value, ep);
 }
 
-Node LoopNode::lookUp(string value, Errpos ep)
+Node LoopNode::lookUp(Symbol value, Errpos ep)
 {
     return defChain->lookUp(value, ep);
 }
 
-Node ForNode::lookUp(string value, Errpos ep)
+Node ForNode::lookUp(Symbol value, Errpos ep)
 {
     return defChain->lookUp(value, ep);
 }
 
-Node AnyNode::lookUp(string value, Errpos ep)
+Node AnyNode::lookUp(Symbol value, Errpos ep)
 {
     return defChain->lookUp(value, ep);
 }
 
-Node ComprehensionNode::lookUp(string value, Errpos ep)
+Node ComprehensionNode::lookUp(Symbol value, Errpos ep)
 {
-    if (var->getNameString() == value)
+    if (var->getSymbol() == value)
         return this;
     else
         return defChain->lookUp(value, ep);
 }
 
-Node RangeNode::lookUp(string value, Errpos ep)
+Node RangeNode::lookUp(Symbol value, Errpos ep)
 {
     return defChain->lookUp(value, ep);
 }
 
-Node EnumSetNode::lookUp(string value, Errpos ep)
+Node EnumSetNode::lookUp(Symbol value, Errpos ep)
 {
     return defChain->lookUp(value, ep);
 }
 
-Node MapSetNode::lookUp(string value, Errpos ep)
+Node MapSetNode::lookUp(Symbol value, Errpos ep)
 {
     return defChain->lookUp(value, ep);
 }
 
-Node SelectNode::lookUp(string value, Errpos ep)
+Node SelectNode::lookUp(Symbol value, Errpos ep)
 {
     return defChain->lookUp(value, ep);
 }
 
-Node FunctionNode::lookUp(string value, Errpos ep)
+Node FunctionNode::lookUp(Symbol value, Errpos ep)
 {
     return defChain->lookUp(value, ep);
 }
 
-Node ListopNode::lookUp(string value, Errpos ep)
+Node ListopNode::lookUp(Symbol value, Errpos ep)
 {
     for (ListIter it = args.begin(); it != args.end(); ++it)
     {
@@ -117,34 +118,34 @@ Node ListopNode::lookUp(string value, Errpos ep)
     return 0;
 }
 
-Node SkipNode::lookUp(string value, Errpos ep)
+Node SkipNode::lookUp(Symbol value, Errpos ep)
 {
     return defChain->lookUp(value, ep);
 }
 
-Node BinopNode::lookUp(string value, Errpos ep)
+Node BinopNode::lookUp(Symbol value, Errpos ep)
 {
     return defChain->lookUp(value, ep); // 090701 Required because a &= e is a statement.
     //   Node lm = lhs->lookUp(value, ep);
     //   return lm ? lm :  rhs->lookUp(value, ep);
 }
 
-Node CondExprNode::lookUp(string value, Errpos ep)
+Node CondExprNode::lookUp(Symbol value, Errpos ep)
 {
     return 0;
 }
 
-Node SubscriptNode::lookUp(string value, Errpos ep)
+Node SubscriptNode::lookUp(Symbol value, Errpos ep)
 {
     return 0;
 }
 
-Node SubrangeNode::lookUp(string value, Errpos ep)
+Node SubrangeNode::lookUp(Symbol value, Errpos ep)
 {
     return 0;
 }
 
-Node EnumTypeNode::lookUp(string value, Errpos ep)
+Node EnumTypeNode::lookUp(Symbol value, Errpos ep)
 {
     for (ListIter it = values.begin(); it != values.end(); ++it)
     {
@@ -155,40 +156,197 @@ Node EnumTypeNode::lookUp(string value, Errpos ep)
     return 0;
 }
 
-Node EnumValueNode::lookUp(string value, Errpos ep)
+Node EnumValueNode::lookUp(Symbol value, Errpos ep)
 {
     return (value == name) ? this : 0;
 }
 
-Node IteratorNode::lookUp(string value, Errpos ep)
+Node IteratorNode::lookUp(Symbol value, Errpos ep)
 {
     return 0;
 }
 
-Node UnopNode::lookUp(string value, Errpos ep)
+Node UnopNode::lookUp(Symbol value, Errpos ep)
 {
     return operand->lookUp(value, ep);
 }
 
-Node ConstantNode::lookUp(string value, Errpos ep)
+Node ConstantNode::lookUp(Symbol value, Errpos ep)
 {
-    return (name->getNameString() == value) ? this : 0;
+    return (name->getSymbol() == value) ? this : 0;
 }
 
-Node DecNode::lookUp(string value, Errpos ep)
+Node DecNode::lookUp(Symbol value, Errpos ep)
 {
     return (
             (type || mk == QUERY || mk == REPLY || generated) &&
-            name->getNameString() == value) ? this : 0;
+            name->getSymbol() == value) ? this : 0;
 }
 
-Node ThreadParamNode::lookUp(string value, Errpos ep)
+Node ThreadParamNode::lookUp(Symbol value, Errpos ep)
 {
-    return name->getNameString() == value ? this : 0;
+    return name->getSymbol() == value ? this : 0;
 }
 
-Node StartNode::lookUp(string value, Errpos ep)
+Node StartNode::lookUp(Symbol value, Errpos ep)
 {
     return defChain->lookUp(value, ep);
 }
 
+
+// Functions that describe lookUp() to a Scope.  Nodes that pass a
+// lookup on along the chain, or that never match, define nothing.
+
+/** By default, lookUp() cannot be described by a table. */
+bool BaseNode::define(Scope & scope)
+{
+    return false;
+}
+
+bool DefNode::define(Scope & scope)
+{
+    // The name takes precedence over the values of an enumeration.
+    if (value->kind() == ENUM_TYPE_NODE)
+        value->define(scope);
+    scope.insert(name->getSymbol(), this);
+    return true;
+}
+
+bool EnumTypeNode::define(Scope & scope)
+{
+    // The first of the values takes precedence over the others.
+    for (List::const_reverse_iterator it = values.rbegin(); it != values.rend(); ++it)
+        (*it)->define(scope);
+    return true;
+}
+
+bool EnumValueNode::define(Scope & scope)
+{
+    scope.insert(name, this);
+    return true;
+}
+
+bool ComprehensionNode::define(Scope & scope)
+{
+    scope.insert(var->getSymbol(), this);
+    return true;
+}
+
+bool ConstantNode::define(Scope & scope)
+{
+    scope.insert(name->getSymbol(), this);
+    return true;
+}
+
+bool DecNode::define(Scope & scope)
+{
+    if (type || mk == QUERY || mk == REPLY || generated)
+        scope.insert(name->getSymbol(), this);
+    return true;
+}
+
+bool ThreadParamNode::define(Scope & scope)
+{
+    scope.insert(name->getSymbol(), this);
+    return true;
+}
+
+bool InstanceNode::define(Scope & scope)
+{
+    return true;
+}
+
+bool SequenceNode::define(Scope & scope)
+{
+    return true;
+}
+
+bool ExitNode::define(Scope & scope)
+{
+    return true;
+}
+
+bool IfNode::define(Scope & scope)
+{
+    return true;
+}
+
+bool CondPairNode::define(Scope & scope)
+{
+    return true;
+}
+
+bool LoopNode::define(Scope & scope)
+{
+    return true;
+}
+
+bool ForNode::define(Scope & scope)
+{
+    return true;
+}
+
+bool AnyNode::define(Scope & scope)
+{
+    return true;
+}
+
+bool RangeNode::define(Scope & scope)
+{
+    return true;
+}
+
+bool EnumSetNode::define(Scope & scope)
+{
+    return true;
+}
+
+bool MapSetNode::define(Scope & scope)
+{
+    return true;
+}
+
+bool SelectNode::define(Scope & scope)
+{
+    return true;
+}
+
+bool FunctionNode::define(Scope & scope)
+{
+    return true;
+}
+
+bool SkipNode::define(Scope & scope)
+{
+    return true;
+}
+
+bool BinopNode::define(Scope & scope)
+{
+    return true;
+}
+
+bool CondExprNode::define(Scope & scope)
+{
+    return true;
+}
+
+bool SubscriptNode::define(Scope & scope)
+{
+    return true;
+}
+
+bool SubrangeNode::define(Scope & scope)
+{
+    return true;
+}
+
+bool IteratorNode::define(Scope & scope)
+{
+    return true;
+}
+
+bool StartNode::define(Scope & scope)
+{
+    return true;
+}
@@ -4,6 +4,7 @@
 #include <iomanip>
 #include <map>
 
+#include "context.h"
 #include "lts.h"
 
 // Set utilities
@@ -65,21 +66,19 @@ void add(int i, int j, vector<int> & eqs)
 
 }
 
-int nextState = 0;
-
 void clearNextState()
 {
-    nextState = 0;
+    CompilationContext::current().nextState = 0;
 }
 
 int newState()
 {
-    return nextState++;
+    return CompilationContext::current().nextState++;
 }
 
 // Implementation of class Trans
 
-Trans::Trans(int start, int finish, string msg) :
+Trans::Trans(int start, int finish, Symbol msg) :
     start(start), finish(finish), msg(msg)
 {}
 
@@ -106,8 +105,18 @@ LTS::LTS(bool dummyLTS)
 LTS::LTS(int start, int finish) : start(start), finish(finish)
 {}
 
+void *LTS::operator new(size_t size)
+{
+    return CompilationContext::current().arena.allocate(size, &Arena::destroy<LTS>);
+}
+
+void LTS::operator delete(void *p)
+{
+    Arena::forget(p);
+}
+
 // Insert a single transition
-void LTS::insert(int s, int f, string msg)
+void LTS::insert(int s, int f, Symbol msg)
 {
     trs.push_back(Trans(s, f, msg));
 }
@@ -144,14 +153,14 @@ void LTS::collapse()
 
     // Initialize equivalence classes of nodes
     vector<int> eqs;
-    for (int i = 0; i < nextState; ++i)
+    for (int i = 0; i < CompilationContext::current().nextState; ++i)
         eqs.push_back(i);
 
     // Process and remove empty transitions
     vector<Trans>::iterator it = trs.begin();
     while (it != trs.end())
     {
-        if (it->msg == "")
+        if (it->msg == Symbol())
         {
             add(it->start, it->finish, eqs);
             it = trs.erase(it);
@@ -241,7 +250,7 @@ void advance(map<int,int> & pairs, LTS *plts, LTS *qlts)
             for (vector<Trans>::const_iterator i = plts->trs.begin(); i != plts->trs.end(); ++i)
             {
                 if (
-                    i->msg != "?" &&
+                    i->msg != ANY_MESSAGE &&
                     member(i->start, mapped) && member(i->finish, mapped) &&
                     ! qlts->hasTrans(Trans(pairs[i->start], pairs[i->finish], i->msg)))
                 {
@@ -3,6 +3,8 @@
 #ifndef LTS_H
 #define LTS_H
 
+#include "symbol.h"
+
 #include <string>
 #include <vector>
 #include <set>
@@ -22,15 +24,18 @@ int newState();
 bool satisfies(LTS *svrlts, LTS *clilts);
 
 
+/** Label of a transition that matches any message. */
+const Symbol ANY_MESSAGE("?");
+
 /**  Transition m from state s to state f with message msg.
- *   msg = "" indicates an empty transition.
+ *   An empty msg indicates an empty transition.
  */
 class Trans
 {
     public:
 
         /** Construct a transition. */
-        Trans(int start, int finish, string msg);
+        Trans(int start, int finish, Symbol msg);
 
         /** Equality test for transitions. */
         bool operator==(const Trans & other) const;
@@ -43,7 +48,7 @@ class Trans
     private:
         int start;
         int finish;
-        string msg;
+        Symbol msg;
 };
 
 // Labelled state transition system
@@ -59,10 +64,16 @@ class LTS
         /** Construct an LTS with given start and finish states and no transitions. */
         LTS(int start, int finish);
 
+        /** Allocate an LTS in the arena of the current compilation. */
+        static void *operator new(size_t size);
+
+        /** Called only if the constructor throws. */
+        static void operator delete(void *p);
+
         /** Insert a transition into an LTS.
-         * msg = 0 indicates an empty transition.
+         * An empty msg indicates an empty transition.
          */
-        void insert(int s, int f, string msg = "");
+        void insert(int s, int f, Symbol msg = Symbol());
 
         /** Insert a collection of transitions. */
         void insert(vector<Trans> t);
@@ -51,10 +51,13 @@
 
 #include "ast.h"
 #include "basicblocks.h"
+#include "context.h"
 #include "error.h"
 #include "functions.h"
 #include "parser.h"
 #include "scanner.h"
+#include "server.h"
+#include "source.h"
 #include "types.h"
 #include "utilities.h"
 #include "llvmgen.h"
@@ -67,10 +70,15 @@
 #include <fstream>
 #include <sstream>
 #include <list>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
 #include <map>
 #include <locale>
 
 #include <glibmm.h>
+
+#include <llvm/System/Host.h>
 //#include <sys/io.h> // patch (not needed)
 
 using namespace std;
@@ -82,60 +90,15 @@ using Glib::ustring;
  *  changes to the prelude, then both this value and prelude.cpp should
  *  be changed.
  */
-const Glib::ustring PRELUDE_VERSION = "44";
-
-/** Compiler option  "A": Write AST to a file. */
-bool drawAST = false;
-
-/** Compiler option  "B": Write basic blocks to log file. */
-bool showBasicBlocks = false;
-
-/** Compiler option  "F": Write function descriptors to log file. */
-bool showFuncs = false;
-
-/** Compiler option  "LP": write log files after parsing. */
-bool logParse = false;
-
-/** Compiler option  "LE": write log files after extracting. */
-bool logExtract = false;
-
-/** Compiler option  "LB": write log files after binding. */
-bool logBind = false;
-
-/** Compiler option  "LC": write log files after checking. */
-bool logCheck = false;
-
-/** Compiler option  "LG": write log files after code generation. */
-bool logGen = false;
+const Glib::ustring PRELUDE_VERSION = "45";
 
-/** Compiler option "R": compile and run.
- *  If this is enabled, no C++ code is generated.
+/** Extract Erasmus source from a Latex file.
+ * \param is is the Latex file.
+ * \param code receives the source text.
+ * \param lines receives, for each line of \a code, the number of the
+ *        line of the Latex file that it came from.
  */
-bool comRun = false;
-
-/** Compiler option  "T": Trace execution */
-bool tracing = false;
-
-/** Compiler option  "T": Number of cycles to trace. */
-int maxCycles = 100;
-
-/** Compiler option  "O": output file nane. */
-Glib::ustring outfilename = "";
-
-/** Compiler option  "W": show warning messages. */
-bool showWarnings = false;
-
-/** Compiler option  "Z": generate LLVM bitcode. */
-bool genLLVM = false;
-
-/** Default path to 'prelude.cpp'. */
-Glib::ustring preludeFileName = "prelude.cpp";
-
-/** Names of C++ files to be included in output. */
-vector<Glib::ustring> cppfilenames;
-
-/** Extract Erasmus source from a Latex file. */
-void extract(istream & is, ostream & os)
+void extract(istream & is, string & code, vector<int> & lines)
 {
     enum
     {
@@ -143,8 +106,10 @@ void extract(istream & is, ostream & os)
     }
     mode = SKIPPING;
     string line;
+    int lineNum = 0;
     while (getline(is, line))
     {
+        ++lineNum;
         switch (mode)
         {
             case SKIPPING:
@@ -156,12 +121,117 @@ void extract(istream & is, ostream & os)
                 if (line.find("\\end{code}") == 0)
                     mode = SKIPPING;
                 else
-                    os << line << endl;
+                {
+                    code += line;
+                    code += '\n';
+                    lines.push_back(lineNum);
+                }
                 break;
         }
     }
+    // The empty line after the last newline.
+    lines.push_back(lineNum + 1);
+}
+
+
+/** \return the compiler version, the options that change code
+ *  generation, and the target, as text to be hashed into the names
+ *  of code cache entries.
+ */
+string codeOptions(const Options & options)
+{
+    ostringstream os;
+    os << PRELUDE_VERSION << ' ' << options.comRun << options.tracing << options.maxCycles << options.debugInfo <<
+        ' ' << llvm::sys::getHostTriple();
+    return os.str();
+}
+
+/** Compute the name of the code cache entry for a program.
+ *  The name is a hash of everything that affects the generated code:
+ *  the source files, the run-time library, the compiler version,
+ *  the options that change code generation, and the target.
+ * \param filenames lists the source files of the program, as built by readFiles().
+ * \param options are the options of the compilation.
+ * \return the path of the entry, which may not exist.
+ */
+Glib::ustring cacheFileName(const vector<Glib::ustring> & filenames, const Options & options)
+{
+    Glib::Checksum sum(Glib::Checksum::CHECKSUM_SHA256);
+    vector<Glib::ustring> inputs(filenames);
+    inputs.push_back(options.runtimeFileName);
+    for (vector<Glib::ustring>::const_iterator it = inputs.begin(); it != inputs.end(); ++it)
+    {
+        ifstream is(it->c_str(), ios::binary);
+        ostringstream text;
+        text << is.rdbuf();
+        ostringstream header;
+        header << *it << ' ' << text.str().size() << '\n';
+        sum.update(header.str());
+        sum.update(text.str());
+    }
+    sum.update(codeOptions(options));
+    return Glib::build_filename(Glib::get_user_cache_dir(), "mec", sum.get_string() + ".bc");
+}
+
+/** Compute the code cache entries of the modules of a program.
+ *  The code of a module depends only on its own text and on the
+ *  modules that it imports, so the entry of a module is a hash of
+ *  its text and of the entries of its imports.  An edit invalidates
+ *  the edited module and the modules that import it, directly or
+ *  indirectly; other modules keep their code.  The entries only hold
+ *  LLVM code: every module is still parsed, bound and checked.
+ * \param cc is the compilation, which holds the files.
+ * \param filenames lists the source files of the program, as built by readFiles().
+ * \param imports gives the files that each file imports, as found by readFiles().
+ * \return path prefixes of the entries, by source file number.
+ */
+map<int, string> moduleCacheEntries(CompilationContext & cc, const vector<Glib::ustring> & filenames,
+                                    const map<int, vector<int> > & imports)
+{
+    map<int, string> keys;
+    map<int, string> entries;
+    string dir = Glib::build_filename(Glib::get_user_cache_dir(), "mec", "modules");
+    // Every file comes after the files that it imports, so their keys are known.
+    for (vector<Glib::ustring>::const_iterator it = filenames.begin(); it != filenames.end(); ++it)
+    {
+        int file = cc.sources.addFile(*it);
+        Glib::Checksum sum(Glib::Checksum::CHECKSUM_SHA256);
+        sum.update(codeOptions(cc.options));
+        // Debug information refers to the file by name.
+        if (cc.options.debugInfo)
+            sum.update(it->raw() + '\n');
+        sum.update(string(cc.sources.begin(file), cc.sources.end(file)));
+        map<int, vector<int> >::const_iterator deps = imports.find(file);
+        if (deps != imports.end())
+            for (vector<int>::const_iterator dep = deps->second.begin(); dep != deps->second.end(); ++dep)
+                sum.update(keys[*dep]);
+        keys[file] = sum.get_string();
+        entries[file] = Glib::build_filename(dir, keys[file]);
+    }
+    return entries;
 }
 
+/** Write the LLVM module of \a cc for \a root in the forms requested by +Z. */
+void writeModule(CompilationContext & cc, const Glib::ustring & root)
+{
+    const Options & options = cc.options;
+    // Ahead-of-time output, linked later against libmert.a.
+    if (options.emitBitcode)
+    {
+        writeBitcode(cc.module, root + ".bc");
+        cc.outputFiles.push_back(root + ".bc");
+    }
+    if (options.emitAssembly)
+    {
+        writeAssembly(cc.module, root + ".ll");
+        cc.outputFiles.push_back(root + ".ll");
+    }
+    if (options.emitObject)
+    {
+        writeObject(cc.module, root + ".o");
+        cc.outputFiles.push_back(root + ".o");
+    }
+}
 
 /** Read the prelude from "// *X" to // *Y".
  * The file \a prelude.cpp contains C++ code that is used by all
@@ -190,129 +260,299 @@ void copyprelude(istream & is, ostream & os, Glib::ustring start)
     }
 }
 
+/** The state of a source file while imports are being resolved. */
+enum ImportState
+{
+    IMPORT_OPEN,    /**< The file's imports are being read. */
+    IMPORT_DONE     /**< The file and all its imports have been read. */
+};
+
+/** An instance holds the module graph of a program while it is built
+ * by readFiles().
+ */
+struct ImportData
+{
+    ImportData(SourceManager & sources, vector<Glib::ustring> & filenames, ostream & log)
+        : sources(sources), filenames(filenames), log(log) {}
+
+    /** The source manager, which reads each file. */
+    SourceManager & sources;
+
+    /** Source files in the order in which they must be scanned:
+     * every file comes after the files that it imports.
+     */
+    vector<Glib::ustring> & filenames;
+
+    /** The log file, which receives a copy of every source file. */
+    ostream & log;
+
+    /** The state of each file found so far, keyed by canonical path. */
+    map<string, ImportState> states;
+
+    /** The number of each file that has been read, keyed by canonical path. */
+    map<string, int> files;
+
+    /** The files that each file imports, by file number. */
+    map<int, vector<int> > imports;
+
+    /** The chain of imports that led to the file being read. */
+    vector<Glib::ustring> chain;
+};
+
 // Forward reference
-void readFiles(Glib::ustring root, int & tfnum, vector<Glib::ustring> & filenames, ostream & log);
+int readFiles(Glib::ustring root, ImportData & id);
 
-/** Check a file for import commands. */
-void checkFile(Glib::ustring efn, int & tfnum, vector<Glib::ustring> & filenames, ostream & log)
+/** Find the modules named by an import command.
+ * \param first and \a last delimit a line that starts with 'import'.
+ * \param names receives the module names.
+ */
+void importNames(const char *first, const char *last, vector<Glib::ustring> & names)
 {
-    ifstream efs(efn.c_str());
-    string buffer;
-    while (getline(efs, buffer))
+    const char *p = first + 6;
+    while (p < last)
+    {
+        while (p < last && (*p == ' ' || *p == '\t' || *p == ','))
+            ++p;
+        const char *start = p;
+        while (p < last && *p != ' ' && *p != '\t' && *p != ',' && *p != ';' && *p != '\r')
+            ++p;
+        if (p > start)
+            names.push_back(Glib::ustring(start, p));
+        while (p < last && (*p == ' ' || *p == '\t'))
+            ++p;
+        if (p == last || *p != ',')
+            break;
+    }
+}
+
+/** Read a source file, read the files that it imports, and copy
+ * it to the log.  The file is read once, into the source manager,
+ * where the scanner will find it.
+ * \return the number of the file.
+ */
+int checkFile(Glib::ustring efn, ImportData & id)
+{
+    int file = id.sources.addFile(efn);
+    const char *text = id.sources.begin(file);
+    const char *end = id.sources.end(file);
+    const vector<int> & lines = id.sources.lineMap(file);
+
+    for (const char *bol = text; bol < end; )
     {
-        Glib::ustring ubuffer(buffer);
-        Glib::ustring::size_type p1 = ubuffer.find_first_not_of(" \t");
-        Glib::ustring::size_type p2 = ubuffer.find("import", p1);
-        if (p2 == p1 && p2 != Glib::ustring::npos)
+        const char *eol = static_cast<const char*>(memchr(bol, '\n', end - bol));
+        if (!eol)
+            eol = end;
+        const char *p = bol;
+        while (p < eol && (*p == ' ' || *p == '\t'))
+            ++p;
+        if (eol - p > 6 && strncmp(p, "import", 6) == 0 && (p[6] == ' ' || p[6] == '\t'))
         {
-            Glib::ustring::size_type pos = p1 + 7;
-            int state = 1;
-            bool scanning = true;
-            Glib::ustring fn;
-            while (scanning && pos < ubuffer.size())
-            {
-                char c = ubuffer[pos];
-                switch (state)
-                {
-                    case 1:
-                        if (c == ' ')
-                            ++pos;
-                        else
-                        {
-                            fn = "";
-                            state = 2;
-                        }
-                        break;
-                    case 2:
-                        if (c == ' ' || c == ',' || c == ';')
-                        {
-                            if (fn.size() > 0)
-                            {
-                                readFiles(fn, tfnum, filenames, log);
-                                fn = "";
-                            }
-                            state = 3;
-                        }
-                        else
-                        {
-                            fn += c;
-                            ++pos;
-                        }
-                        break;
-                    case 3:
-                        if (c == ' ')
-                            ++pos;
-                        else if (c == ',')
-                        {
-                            ++pos;
-                            state = 1;
-                        }
-                        else if (c == ';')
-                            scanning = false;
-                        break;
-                }
-            }
-            if (fn.size() > 0)
-                readFiles(fn, tfnum, filenames, log);
+            vector<Glib::ustring> names;
+            importNames(p, eol, names);
+            for (vector<Glib::ustring>::const_iterator it = names.begin(); it != names.end(); ++it)
+                id.imports[file].push_back(readFiles(*it, id));
         }
+        bol = eol + 1;
     }
-    efs.clear();
-    efs.seekg(0);
-    log << endl << "Input file '" << efn << "':\n";
+
+    id.log << endl << "Input file '" << efn << "':\n";
     int line = 0;
-    while (getline(efs, buffer))
-        log << setw(4) << ++line << ' ' << buffer << endl;
-    efs.close();
-    filenames.push_back(efn);
+    for (const char *bol = text; bol < end; )
+    {
+        const char *eol = static_cast<const char*>(memchr(bol, '\n', end - bol));
+        if (!eol)
+            eol = end;
+        id.log << setw(4) << (lines.empty() ? line + 1 : lines[line]) << ' ';
+        ++line;
+        id.log.write(bol, eol - bol);
+        id.log << endl;
+        bol = eol + 1;
+    }
+    id.filenames.push_back(efn);
+    return file;
 }
 
-/** Read a source file, recursively read imports. */
-void readFiles(Glib::ustring root, int & tfnum, vector<Glib::ustring> & filenames, ostream & log)
+/** Read a source file and, recursively, the files that it imports.
+ * A file that has been read already, perhaps by another name, is
+ * skipped; a file that imports itself, directly or indirectly, is
+ * an error.
+ * \return the number of the file.
+ */
+int readFiles(Glib::ustring root, ImportData & id)
 {
     Glib::ustring efn = root + ".e";
+    Glib::ustring tfn = root + ".tex";
+    bool latex = false;
     ifstream efs(efn.c_str());
     if (efs)
-    {
         efs.close();
-        checkFile(efn, tfnum, filenames, log);
-    }
     else // No .e file, try .tex
     {
-        Glib::ustring tfn = root + ".tex";
         ifstream tfs(tfn.c_str());
-        if (tfs)
+        if (!tfs)
+            Error() << "Failed to open either '" << efn << "' or '" << tfn << "'\n" << THROW;
+        latex = true;
+    }
+    Glib::ustring fn = latex ? tfn : efn;
+
+    string path = canonicalPath(fn);
+    map<string, ImportState>::const_iterator it = id.states.find(path);
+    if (it != id.states.end())
+    {
+        if (it->second == IMPORT_OPEN)
+        {
+            ostringstream cycle;
+            vector<Glib::ustring>::const_iterator ci = id.chain.begin();
+            while (canonicalPath(*ci) != path)
+                ++ci;
+            for ( ; ci != id.chain.end(); ++ci)
+                cycle << "'" << *ci << "' -> ";
+            Error() << "Import cycle: " << cycle.str() << "'" << fn << "'.\n" << THROW;
+        }
+        return id.files[path];
+    }
+    id.states[path] = IMPORT_OPEN;
+    id.chain.push_back(fn);
+
+    if (latex)
+    {
+        // The code is extracted into memory, where the scanner finds it.
+        ifstream tfs(tfn.c_str());
+        CompilationContext::current().diagnostics() << "Extracting '" << tfn << "'\n";
+        string code;
+        vector<int> lines;
+        extract(tfs, code, lines);
+        tfs.close();
+        id.sources.addText(tfn, code, lines);
+    }
+    int file = checkFile(fn, id);
+
+    id.chain.pop_back();
+    id.states[path] = IMPORT_DONE;
+    id.files[path] = file;
+    return file;
+}
+
+/** A source file that is scanned and parsed on its own, possibly
+ * at the same time as other files.
+ */
+struct ParseUnit
+{
+    ParseUnit(CompilationContext & context, const Glib::ustring & filename)
+        : context(&context), filename(filename), failed(false) {}
+
+    /** The compilation that the file belongs to. */
+    CompilationContext *context;
+
+    /** The file to parse. */
+    Glib::ustring filename;
+
+    /** The position of the first token of the file. */
+    Errpos ep;
+
+    /** The top-level definitions of the file. */
+    List nodes;
+
+    /** The nodes made while parsing the file, to be numbered in file order. */
+    ParseNumbering numbering;
+
+    /** Set if parsing was abandoned; \a message says why. */
+    bool failed;
+    Glib::ustring message;
+};
+
+/** Scan and parse one file.  This runs on a worker thread. */
+static void parseUnit(ParseUnit *unit)
+{
+    CompilationContext::setCurrent(unit->context);
+    ParseNumbering::setCurrent(&unit->numbering);
+    try
+    {
+        TokenStream tokens(vector<Glib::ustring>(1, unit->filename));
+        Parser pa(tokens);
+        unit->ep = tokens->ep();
+        unit->nodes = pa.parseDefinitions();
+    }
+    catch (const Glib::ustring & msg)
+    {
+        unit->failed = true;
+        unit->message = msg;
+    }
+    ParseNumbering::setCurrent(0);
+}
+
+/** Scan and parse the source files of a program in parallel.
+ * \param cc is the compilation.
+ * \param filenames lists the files in import order, as built by readFiles().
+ * \return a program containing the definitions of all the files, in import order.
+ */
+Node parseFiles(CompilationContext & cc, const vector<Glib::ustring> & filenames)
+{
+    vector<ParseUnit*> units;
+    for (vector<Glib::ustring>::const_iterator it = filenames.begin(); it != filenames.end(); ++it)
+    {
+        cc.diagnostics() << "Compiling   '" << *it << "'\n";
+        units.push_back(new ParseUnit(cc, *it));
+    }
+
+    if (units.size() > 1 && cc.workers() > 1)
+    {
+        Glib::ThreadPool pool(cc.workers());
+        for (vector<ParseUnit*>::iterator it = units.begin(); it != units.end(); ++it)
+            pool.push(sigc::bind(sigc::ptr_fun(&parseUnit), *it));
+        pool.shutdown();
+    }
+    else
+        for (vector<ParseUnit*>::iterator it = units.begin(); it != units.end(); ++it)
+            parseUnit(*it);
+
+    Errpos ep = units.empty() ? Errpos() : units.front()->ep;
+    List nodes;
+    Glib::ustring message;
+    for (vector<ParseUnit*>::iterator it = units.begin(); it != units.end(); ++it)
+    {
+        ParseUnit *unit = *it;
+        unit->numbering.number(cc);
+        if (unit->failed)
         {
-            ostringstream oss;
-            oss << "temp_" << ++tfnum << ".e";
-            Glib::ustring tempfn = oss.str();
-            ofstream ofs(tempfn.c_str());
-            cout << "Extracting '" << tfn << "' -> '" << tempfn << "'\n";
-            extract(tfs, ofs);
-            tfs.close();
-            ofs.close();
-            checkFile(tempfn, tfnum, filenames, log);
+            if (message.empty())
+                message = unit->message;
         }
         else
-            Error() << "Failed to open either '" << efn << "' or '" << tfn << "'\n" << THROW;
+            nodes.insert(nodes.end(), unit->nodes.begin(), unit->nodes.end());
+        delete unit;
     }
+    if (!message.empty())
+        throw message;
+    return new ProgramNode(ep, nodes);
 }
 
+/** Releases an arena when it goes out of scope. */
+struct ArenaRelease
+{
+    ArenaRelease(Arena & arena) : arena(arena) {}
+    ~ArenaRelease() { arena.release(); }
+    Arena & arena;
+};
+
 /** Process one command-line argument.
  *  By default, the argument is a file name without extension.
  * If its first character is '+' or '-', it is processed
  * as a compiler option.
+ * \param cc is the compilation, which holds its options.
  * \param clArg is the command-line argument.
  * \return \a true if no errors, \a false if errors.
  */
-bool compile(Glib::ustring clArg)
+bool compile(CompilationContext & cc, Glib::ustring clArg)
 {
+    Options & options = cc.options;
 
     // Process compiler options
     if (clArg[0] == '+' || clArg[0] == '-')
     {
         if (clArg.size() < 2)
         {
-            cerr << "Unknown option '" << clArg << "'.\n";
+            cc.diagnostics() << "Unknown option '" << clArg << "'.\n";
             return false;
         }
         switch (clArg[1])
@@ -321,27 +561,27 @@ bool compile(Glib::ustring clArg)
             // Write AST to output file
             case 'a':
             case 'A':
-                drawAST = clArg[0] == '+';
+                options.drawAST = clArg[0] == '+';
                 break;
 
                 // Write basic blocks to logfile
             case 'b':
             case 'B':
-                showBasicBlocks = clArg[0] == '+';
+                options.showBasicBlocks = clArg[0] == '+';
                 break;
 
             case 'c':
             case 'C':
                 if (clArg[2] == '"')
-                    cppfilenames.push_back(clArg.substr(3, clArg.size() - 4));
+                    options.cppfilenames.push_back(clArg.substr(3, clArg.size() - 4));
                 else
-                    cppfilenames.push_back(clArg.substr(2));
+                    options.cppfilenames.push_back(clArg.substr(2));
                 break;
 
                 // Write function descriptors to log file.
             case 'f':
             case 'F':
-                showFuncs =  clArg[0] == '+';
+                options.showFuncs =  clArg[0] == '+';
                 break;
 
                 // Logfile switch
@@ -355,53 +595,62 @@ bool compile(Glib::ustring clArg)
                         {
                             case 'p':
                             case 'P':
-                                logParse = true;
+                                options.logParse = true;
                                 break;
 
                             case 'e':
                             case 'E':
-                                logExtract = true;
+                                options.logExtract = true;
                                 break;
 
                             case 'b':
                             case 'B':
-                                logBind = true;
+                                options.logBind = true;
                                 break;
 
                             case 'c':
                             case 'C':
-                                logCheck = true;
+                                options.logCheck = true;
                                 break;
 
                             case 'g':
                             case 'G':
-                                logGen = true;
+                                options.logGen = true;
                                 break;
                         }
                     }
                 }
                 break;
 
+                // Code cache
+            case 'k':
+            case 'K':
+                options.useCache = clArg[0] == '+';
+                break;
+
                 // Output file name
             case 'o':
             case 'O':
                 if (clArg[2] == '"')
-                    outfilename = clArg.substr(3, clArg.size() - 4);
+                    options.outfilename = clArg.substr(3, clArg.size() - 4);
                 else
-                    outfilename = clArg.substr(2);
+                    options.outfilename = clArg.substr(2);
                 break;
 
                 // Prelude file name
             case 'p':
             case 'P':
                 if (clArg[0] == '+')
-                    preludeFileName = clArg.substr(2) + DIRECTORY_SEPARATOR_S "prelude.cpp";
+                {
+                    options.preludeFileName = clArg.substr(2) + DIRECTORY_SEPARATOR_S "prelude.cpp";
+                    options.runtimeFileName = clArg.substr(2) + DIRECTORY_SEPARATOR_S "mert.bc";
+                }
                 break;
 
                 // Compile and run
             case 'r':
             case 'R':
-                comRun = (clArg[0]=='+');
+                options.comRun = (clArg[0]=='+');
                 break;
 
                 // Tracing switch
@@ -409,58 +658,104 @@ bool compile(Glib::ustring clArg)
             case 'T':
                 if (clArg[0] == '+')
                 {
-                    tracing = true;
+                    options.tracing = true;
                     if (clArg.size() > 2)
                     {
-                        maxCycles = 0;
+                        options.maxCycles = 0;
                         for (size_t i = 2; i < clArg.size(); ++i)
                         {
                             char c = clArg[i];
                             if (isdigit(c))
-                                maxCycles = 10 * maxCycles + c - '0';
+                                options.maxCycles = 10 * options.maxCycles + c - '0';
                             else
                             {
-                                cerr << "Unknown option '" << clArg << "'.\n";
+                                cc.diagnostics() << "Unknown option '" << clArg << "'.\n";
                                 return false;
                             }
                         }
                     }
                 }
                 else
-                    tracing = false;
+                    options.tracing = false;
                 break;
 
+                // Compile server, client and batch: see main().
+            case 'j':
+            case 'J':
+            case 's':
+            case 'S':
+            case 'x':
+            case 'X':
+                cc.diagnostics() << "Option '" << clArg << "' must be the first argument.\n";
+                return false;
+
                 // Show warning messages for incompatible protocols.
             case 'w':
             case 'W':
-                showWarnings = clArg[0] == '+';
+                options.showWarnings = clArg[0] == '+';
                 break;
 
 
 	   // Generate LLVM Byte Code
          case 'z':
          case 'Z':
-            genLLVM = clArg[0] == '+';
+            options.genLLVM = clArg[0] == '+';
+            options.emitBitcode = options.emitAssembly = options.emitObject = options.debugInfo = false;
+            if (options.genLLVM)
+            {
+                for (int i = 2; i < clArg.size(); ++i)
+                {
+                    switch (clArg[i])
+                    {
+                        case 'b':
+                        case 'B':
+                            options.emitBitcode = true;
+                            break;
+
+                        case 'l':
+                        case 'L':
+                            options.emitAssembly = true;
+                            break;
+
+                        case 'o':
+                        case 'O':
+                            options.emitObject = true;
+                            break;
+
+                        case 'g':
+                        case 'G':
+                            options.debugInfo = true;
+                            break;
+
+                        default:
+                            cc.diagnostics() << "Unknown option '" << clArg << "'.\n";
+                            return false;
+                    }
+                }
+            }
             break;
 
             default:
-                cerr << "Unknown option '" << clArg << "'.\n";
+                cc.diagnostics() << "Unknown option '" << clArg << "'.\n";
                 return false;
         }
 
-        if (showFuncs)
+        if (options.showFuncs)
         {
             showFuncDefs("coercions.tex", "functions.tex", funcDefs);
-            cerr << "Function tables written.\n";
+            cc.diagnostics() << "Function tables written.\n";
         }
         return true;
     }
 
 
-    // The scanner must be kept in scope, because it contains pointers
-    // to the source text that are used for error reporting.
-    // The scanner appends tokens to the eponymous list.
-    Scanner sc;
+    // The source text, which is used for error reporting, is kept
+    // by 'sources' until the next program is compiled.
+    cc.sources.clear();
+
+    // The nodes, blocks and LTSs of the program are released in one
+    // step when it has been compiled, however compilation ends.
+    ArenaRelease release(cc.arena);
 
     try
     {
@@ -473,32 +768,42 @@ bool compile(Glib::ustring clArg)
         else
             root = clArg;
 
-        cerr << "Root = " << root << endl;
+        cc.diagnostics() << "Root = " << root << endl;
 
         Glib::ustring codefilename   = root + ".cpp";
-        if (outfilename != "")
-            codefilename = outfilename;
+        if (options.outfilename != "")
+            codefilename = options.outfilename;
         Glib::ustring logfilename    = root + ".log";
         ofstream log(logfilename.c_str());
         log << "MEC " << today() << endl;
+        cc.outputFiles.push_back(logfilename);
 
         // Build a list of files to scan.
         vector<Glib::ustring> filenames;
         //      filenames.push_back(sysProtName);
 
-        int tfnum = 0;
-        readFiles(root, tfnum, filenames, log);
+        ImportData id(cc.sources, filenames, log);
+        readFiles(root, id);
 
-        list<Token> tokens;
-        // Phase 1: scan source files
-        for (vector<Glib::ustring>::const_iterator it = filenames.begin();
-             it != filenames.end();
-             ++it)
+        // A program that is only run needs nothing but its code, which
+        // may be in the cache.  Options that ask for output from the
+        // front end bypass the cache.
+        bool cacheable = options.useCache && options.comRun && !options.drawAST && !options.showBasicBlocks &&
+                         !options.logParse && !options.logExtract && !options.logBind && !options.logCheck && !options.logGen;
+        Glib::ustring cachefilename;
+        if (cacheable)
         {
-            cout << "Compiling   '" << *it << "'\n";
-            sc.scanFile(*it, tokens);
+            cachefilename = cacheFileName(filenames, options);
+            if (Module *cached = loadCachedModule(cachefilename, *cc.llvmContext))
+            {
+                cc.diagnostics() << "Using cached code '" << cachefilename << "'.\n";
+                delete cc.module;
+                cc.module = cached;
+                writeModule(cc, root);
+                cc.diagnostics() << "Done!\n";
+                return true;
+            }
         }
-        tokens.push_back(Token(Errpos(), END_OF_FILE, "EOF"));
 
         // Construct AST nodes for standard input and output.
         List fds;
@@ -533,11 +838,12 @@ bool compile(Glib::ustring clArg)
         sysPortNode->setDefChain(sysDefNode);
         Node defChain = sysPortNode;
 
-        // Phase 2: build AST by parsing tokens.
-        Parser pa(tokens);
-        Node prog = pa.parseProgram();
+        // Phases 1 and 2: build AST by parsing tokens,
+        // which are scanned from the source files as they are needed.
+        // Each file is parsed on its own, in parallel with the others.
+        Node prog = parseFiles(cc, filenames);
 
-        if (logParse)
+        if (options.logParse)
             log << "\n\nAST after parsing:\n" << prog;
 
         if (errorCount() > 0)
@@ -547,7 +853,7 @@ bool compile(Glib::ustring clArg)
         int tempCounter = 0;
         prog->extract(tempCounter);
 
-        if (logExtract)
+        if (options.logExtract)
             log << "\n\nAST after extracting:\n" << prog;
 
         // Display program text after modification by parser and extract.
@@ -557,19 +863,19 @@ bool compile(Glib::ustring clArg)
         // Phase 3: bind names to their definitions.
         prog->bind(defChain);
 
-        if (logBind)
+        if (options.logBind)
             log << "\n\nAST after binding:\n" << prog;
 
         // Phase 4: check semantics using a CheckData object to transfer
         // information around the ST.
-        CheckData cd(showWarnings);
+        CheckData cd(options.showWarnings);
         prog->check(cd);
-        if (logCheck)
+        if (options.logCheck)
             log << "\n\nAST after checking:\n" << prog;
 
         int numErrors = errorCount();
         if (numErrors > 0)
-            cout << numErrors << " errors!  No code generated.\n";
+            cc.diagnostics() << numErrors << " errors!  No code generated.\n";
         else
         {
             // Phase 5: decorate the AST with the information needed for
@@ -578,7 +884,7 @@ bool compile(Glib::ustring clArg)
             GenData gd;
             prog->gen(gd);
 
-            if (comRun)
+            if (options.comRun)
             {
                 //AssemData aData;
                 //prog->prepAssem(aData);
@@ -591,16 +897,16 @@ bool compile(Glib::ustring clArg)
                 // to a linear list of (not really) basic blocks.
                 BlockList blocks;
                 prog->genBlocks(blocks);
-                if (showBasicBlocks)
+                if (options.showBasicBlocks)
                 {
                     log << "\nBasic Blocks\n";
                     prog->showBB(log);
                 }
 
                 // Phase 7: interleave the generated code with pieces of the prelude.
-                ifstream prelude(preludeFileName.c_str());
+                ifstream prelude(options.preludeFileName.c_str());
                 if ( ! prelude.good())
-                    Error() << "Failed to open '" << preludeFileName << "'\n" << THROW;
+                    Error() << "Failed to open '" << options.preludeFileName << "'\n" << THROW;
 
                 string firstLine;
                 getline(prelude, firstLine);
@@ -611,24 +917,25 @@ bool compile(Glib::ustring clArg)
                 Glib::ustring version = firstLine.substr(b, (e==ustring::npos)?ustring::npos:b-e);
                 if (version != PRELUDE_VERSION)
                 {
-                    cerr << "Incompatibility:\n";
-                    cerr << "    Compiler version is    " << PRELUDE_VERSION << ".\n";
-                    cerr << "    " << preludeFileName << " version is " << version << ".\n";
+                    cc.diagnostics() << "Incompatibility:\n";
+                    cc.diagnostics() << "    Compiler version is    " << PRELUDE_VERSION << ".\n";
+                    cc.diagnostics() << "    " << options.preludeFileName << " version is " << version << ".\n";
                     Error() << "Versions are incompatible." << THROW;
                 }
-                cout << "Reading '" << preludeFileName << "' version " << version << ".\n";
+                cc.diagnostics() << "Reading '" << options.preludeFileName << "' version " << version << ".\n";
 
                 // Open output file
                 ofstream src(codefilename.c_str());
+                cc.outputFiles.push_back(codefilename);
                 copyprelude(prelude, src, "A");
 
                 // Copy user declarations
-                for (vector<Glib::ustring>::const_iterator it = cppfilenames.begin(); it != cppfilenames.end(); ++it)
+                for (vector<Glib::ustring>::const_iterator it = options.cppfilenames.begin(); it != options.cppfilenames.end(); ++it)
                 {
                     ifstream is(it->c_str());
                     if (!is)
                         Error() << "Failed to open '" << *it << "'\n" << THROW;
-                    cerr << "Copying '" << *it << "'\n";
+                    cc.diagnostics() << "Copying '" << *it << "'\n";
                     src << "// Function definitions from '" << *it << "'\n";
                     while (is)
                     {
@@ -653,80 +960,309 @@ bool compile(Glib::ustring clArg)
                 //prog->writeParts(src, ACTION_BODIES);
 
                 copyprelude(prelude, src, "B");
-                if (tracing)
-                    src << "   int cycles = " << maxCycles << ";\n";
+                if (options.tracing)
+                    src << "   int cycles = " << options.maxCycles << ";\n";
 
                 // Create process classes
                 //prog->writeParts(src, CREATE_PROCESSES);
 
                 copyprelude(prelude, src, "C");
-                if (tracing)
+                if (options.tracing)
                     copyprelude(prelude, src, "E");
                 copyprelude(prelude, src, "F");
 
                 src.close();
                 prelude.close();
             }
-            if (logGen)
+            if (options.logGen)
                 log << "\n\nAST after code generation:\n" << prog;
 
             // Draw AST
-            if (drawAST)
+            if (options.drawAST)
             {
                 Glib::ustring astfilename = root + ".ast";
                 set<int> nodeNums;
                 ofstream ast(astfilename.c_str());
+                cc.outputFiles.push_back(astfilename);
                 prog->drawAST(ast, nodeNums, 0);
                 ast << endl;
                 ast.close();
-                cerr << "AST written to " << astfilename << ".\n";
+                cc.diagnostics() << "AST written to " << astfilename << ".\n";
             }
 
 	// Generate LLVM
-         if (genLLVM)
+         if (options.genLLVM || options.comRun)
          {
+            // Each program gets a module of its own.
+            delete cc.module;
+            cc.module = new Module(root.raw(), *cc.llvmContext);
+
             // Phase 6: convert the tree-structured program (in the AST)
             // to a linear list of (not really) basic blocks.
             BlockList blocks;
             prog->genBlocks(blocks);
-            if (showBasicBlocks)
+            if (options.showBasicBlocks)
             {
                log << "\nBasic Blocks\n";
                prog->showBB(log);
             }
 
-            prog->genLLVM();
-	     std::cerr << "LLVM Generated " << ".\n";
+            // Process types are generated and optimised in parallel
+            // and linked into the module of the compilation.
+            {
+                LLVMData ld(*cc.llvmContext, cc.module, options.debugInfo);
+                // Units of other files are created as code refers to them.
+                if (options.debugInfo)
+                    ld.compileUnit(cc.sources.addFile(filenames.back()), true);
+                ld.tiered = options.comRun;
+                if (options.useCache)
+                    ld.cacheEntries = moduleCacheEntries(cc, filenames, id.imports);
+                prog->genLLVM(ld);
+            }
+	     cc.diagnostics() << "LLVM Generated " << ".\n";
+
+            // Link the run-time library afterwards, so that conversions,
+            // checks and channel operations are inlined.
+            // Code that is run here needs the definitions; saved code
+            // takes them from libmert.a.
+            linkRuntime(cc.module, options.runtimeFileName, !options.comRun);
+            if (!options.comRun)
+                optimizeLinked(cc.module);
+            if (cacheable)
+                storeCachedModule(cc.module, cachefilename);
+
+            writeModule(cc, root);
          }
 
 
-            cout << "Done!\n";
+            cc.diagnostics() << "Done!\n";
         }
     }
     catch (const Glib::ustring & msg)
     {
-        cerr << msg << "\nCompilation terminated.\n";
+        cc.diagnostics() << msg << "\nCompilation terminated.\n";
         return false;
     }
     return errorCount() == 0;
 }
 
+/** Compile the program given by \a args, and run it if +R is given.
+ * The compilation has a context of its own, so several compilations
+ * may run at the same time on different threads.
+ * \param args are the command-line arguments, without the program name.
+ * \param outputs receives the names of the files written.
+ * \return the exit status.
+ */
+int compileAndRun(const vector<string> & args, vector<string> & outputs)
+{
+    CompilationContext cc;
+    CompilationContext::setCurrent(&cc);
+
+    // Make the module, which holds all the code.
+    cc.llvmContext = new LLVMContext;
+    cc.module = new Module("main", *cc.llvmContext);
+
+    const Options & options = cc.options;
+    for (vector<string>::const_iterator it = args.begin(); it != args.end(); ++it)
+    {
+        if (!compile(cc, *it))
+        {
+            outputs = cc.outputFiles;
+            CompilationContext::setCurrent(0);
+            return 1;
+        }
+    }
+
+
+   // Create the JIT.  Code that is run starts without optimisation.
+   // The engine is not deleted, because its module provider would
+   // delete the module a second time.
+  ExecutionEngine *engine = EngineBuilder(cc.module)
+      .setOptLevel(options.comRun ? CodeGenOpt::None : CodeGenOpt::Default)
+      .create();
+  if (options.debugInfo)
+      engine->RegisterJITEventListener(new PerfMapListener);
+
+  int status = 0;
+  {
+    ExistingModuleProvider OurModuleProvider(cc.module);
+    FunctionPassManager OurFPM(&OurModuleProvider);
+      
+    // Set up the optimizer pipeline.  Start with registering info about how the
+    // target lays out data structures.
+    OurFPM.add(new TargetData(*engine->getTargetData()));
+    // Promote allocas to registers.
+    OurFPM.add(createPromoteMemoryToRegisterPass());
+    // Do simple "peephole" optimizations and bit-twiddling optzns.
+    OurFPM.add(createInstructionCombiningPass());
+    // Reassociate expressions.
+    OurFPM.add(createReassociatePass());
+    // Eliminate Common SubExpressions.
+    OurFPM.add(createGVNPass());
+    // Simplify the control flow graph (deleting unreachable blocks, etc).
+    OurFPM.add(createCFGSimplificationPass());
+
+    OurFPM.doInitialization();
+
+    // Run the main "interpreter loop" now.
+    MainLoop();
+
+    // Run the program.  Hot process types are optimised by OurFPM
+    // in the background, so everything else is compiled first.
+    if (options.comRun)
+    {
+        Function *entry = cc.module->getFunction("main");
+        if (entry)
+        {
+            engine->DisableLazyCompilation(true);
+            engine->getPointerToFunction(entry);
+            TieredJIT tiers(engine, cc.module, &OurFPM, options.hotThreshold);
+            tiers.start();
+            vector<string> args(1, cc.module->getModuleIdentifier());
+            engine->runStaticConstructorsDestructors(false);
+            status = engine->runFunctionAsMain(entry, args, 0);
+            engine->runStaticConstructorsDestructors(true);
+            tiers.stop();
+        }
+    }
+    
+    // Print out all of the generated code, unless it has been saved or run.
+    if (!options.emitBitcode && !options.emitAssembly && !options.emitObject && !options.comRun)
+        cc.module->dump();
+    
+  }  // Free module provider (and thus the module) and pass manager.
+    cc.module = 0;
+
+    outputs = cc.outputFiles;
+    CompilationContext::setCurrent(0);
+    return status;
+}
+
+/** A program that is compiled in batch mode (+J). */
+struct BatchJob
+{
+    BatchJob() : ok(false) {}
+
+    /** The options that precede the program, and its name. */
+    vector<string> args;
+
+    /** Error messages and warnings from compiling the program. */
+    ostringstream diagnostics;
+
+    /** Set if the program compiled without errors. */
+    bool ok;
+};
+
+/** Compile one program of a batch in a context of its own.
+ * This runs on a worker thread.
+ */
+static void compileJob(BatchJob *job)
+{
+    CompilationContext cc;
+    CompilationContext::setCurrent(&cc);
+    cc.llvmContext = new LLVMContext;
+    cc.diagnosticStream = &job->diagnostics;
+    cc.options.threads = 1;
+
+    job->ok = true;
+    for (vector<string>::const_iterator it = job->args.begin(); job->ok && it + 1 != job->args.end(); ++it)
+        job->ok = compile(cc, *it);
+    if (job->ok && cc.options.comRun)
+    {
+        job->diagnostics << "Option '+R' cannot be used in batch mode.\n";
+        job->ok = false;
+    }
+    if (job->ok)
+        job->ok = compile(cc, job->args.back());
+
+    CompilationContext::setCurrent(0);
+}
+
+/** Compile several programs in parallel, each in a context of its
+ * own, so that a failure does not stop the others.  As usual, each
+ * option applies to the programs that follow it.  The diagnostics
+ * of each program are reported together, in the order given.
+ * \param threads is the number of programs compiled at once, or 0 for one per processor.
+ * \param args are the command-line arguments that follow +J.
+ * \return the exit status: 0 if every program compiled.
+ */
+int compileBatch(unsigned threads, const vector<string> & args)
+{
+    vector<string> options;
+    vector<BatchJob*> jobs;
+    for (vector<string>::const_iterator it = args.begin(); it != args.end(); ++it)
+    {
+        if (it->empty())
+            continue;
+        if ((*it)[0] == '+' || (*it)[0] == '-')
+            options.push_back(*it);
+        else
+        {
+            BatchJob *job = new BatchJob;
+            job->args = options;
+            job->args.push_back(*it);
+            jobs.push_back(job);
+        }
+    }
+
+    {
+        Glib::ThreadPool pool(threads > 0 ? threads : CompilationContext::current().workers());
+        for (vector<BatchJob*>::iterator it = jobs.begin(); it != jobs.end(); ++it)
+            pool.push(sigc::bind(sigc::ptr_fun(&compileJob), *it));
+        pool.shutdown();
+    }
+
+    int failures = 0;
+    for (vector<BatchJob*>::iterator it = jobs.begin(); it != jobs.end(); ++it)
+    {
+        BatchJob *job = *it;
+        cerr << "\n'" << job->args.back() << "': " << (job->ok ? "compiled" : "failed") << ".\n" <<
+            job->diagnostics.str();
+        if (!job->ok)
+            ++failures;
+        delete job;
+    }
+    cerr << "\n" << jobs.size() - failures << " of " << jobs.size() << " programs compiled.\n";
+    return failures > 0 ? 1 : 0;
+}
+
 int main(int argc, char *argv[])
 {
+    // A client only sends its arguments to a compile server,
+    // so it does none of the work of starting the compiler.
+    if (argc > 1 && argv[1][0] == '+' && (argv[1][1] == 'x' || argv[1][1] == 'X'))
+    {
+        CompileRequest request;
+        request.directory = Glib::get_current_dir();
+        request.args.assign(argv + 2, argv + argc);
+        CompileReply reply;
+        try
+        {
+            requestCompile(argv[1] + 2, request, reply);
+        }
+        catch (const Glib::ustring & msg)
+        {
+            cerr << msg;
+            return 1;
+        }
+        cerr << reply.diagnostics;
+        for (vector<string>::const_iterator it = reply.outputs.begin(); it != reply.outputs.end(); ++it)
+            cout << *it << '\n';
+        return reply.status;
+    }
 
     locale user_locale = locale("");
     locale::global(user_locale);
     Glib::init();
+    Glib::thread_init();
+    llvm_start_multithreaded();
 
   InitializeNativeTarget();
-  LLVMContext &Context = getGlobalContext();
-
-  // Make the module, which holds all the code.
-  TheModule = new Module("main", Context);
 
     cerr << "MEC (" << today() << ").\n\n";
 
     buildFuncDefs(funcDefs);
+    buildConversions(funcDefs);
 
     if (argc <= 1)
     {
@@ -741,85 +1277,67 @@ int main(int argc, char *argv[])
             "      B    Write basic blocks to log file\n"
             "      Cf   Read C++ function definitions from file 'f'\n"
             "      F    Display built-in functions\n"
+            "      Jn   Compile the programs that follow in parallel, n at a time (first argument)\n"
             "      LP   Write AST to log file after parsing\n"
             "      LE   Write AST to log file after extracting\n"
             "      LB   Write AST to log file after binding\n"
             "      LC   Write AST to log file after checking\n"
             "      LG   Write AST to log file after generating code\n"
+            "      K    Reuse the code of unchanged programs (+R), and the LLVM code\n"
+            "           of unchanged modules, from the code cache (off by default)\n"
             "      Of   Write C++ code to file 'f'\n"
-            "      P<path>  Read 'prelude.cpp' from the given path\n"
+            "      P<path>  Read 'prelude.cpp' and 'mert.bc' from the given path\n"
             "      R    Compile and run (suppresses .cpp output)\n"
+            "      S<path>  Serve compile requests on Unix socket 'path' (first argument)\n"
             "      T    Trace execution until program terminates\n"
             "      Tn   Trace execution for n context switches\n"
             "      W    Show warnings about incompatible protocols\n"
+            "      X<path>  Send the other arguments to the server on 'path' (first argument)\n"
             "      Z    Generate LLVM Code\n"
+            "      ZB   Also write LLVM bitcode to .bc file\n"
+            "      ZL   Also write LLVM assembly to .ll file\n"
+            "      ZO   Also write native object to .o file (link with -lmert)\n"
+            "      ZG   Also write line information and /tmp/perf-<pid>.map\n"
             "   -------------------------------------------------------------\n"
             " Default settings: ";
-        cerr << (drawAST         ? "+A"   : "-A")  << ' ';
-        cerr << (showBasicBlocks ? "+B"   : "-B")  << ' ';
-        cerr << (showFuncs       ? "+F"   : "-F")  << ' ';
-        cerr << (logParse        ? "+LP" : "-LP")  << ' ';
-        cerr << (logExtract      ? "+LE" : "-LE")  << ' ';
-        cerr << (logBind         ? "+LB" : "-LB")  << ' ';
-        cerr << (logCheck        ? "+LC" : "-LC")  << ' ';
-        cerr << (logGen          ? "+LG" : "-LG")  << ' ';
-        cerr << "+P" << preludeFileName            << ' ';
-        cerr << (comRun          ? "+R"   : "-R")  << ' ';
-        cerr << (tracing         ? "+T"   : "-T")  << ' ';
-        cerr << (showWarnings    ? "+W"   : "-W")  << ' ';
-        cerr << (genLLVM    	    ? "+Z"   : "-Z")  << ' ';
+        Options defaults;
+        cerr << (defaults.drawAST         ? "+A"   : "-A")  << ' ';
+        cerr << (defaults.showBasicBlocks ? "+B"   : "-B")  << ' ';
+        cerr << (defaults.showFuncs       ? "+F"   : "-F")  << ' ';
+        cerr << (defaults.logParse        ? "+LP" : "-LP")  << ' ';
+        cerr << (defaults.logExtract      ? "+LE" : "-LE")  << ' ';
+        cerr << (defaults.logBind         ? "+LB" : "-LB")  << ' ';
+        cerr << (defaults.logCheck        ? "+LC" : "-LC")  << ' ';
+        cerr << (defaults.logGen          ? "+LG" : "-LG")  << ' ';
+        cerr << (defaults.useCache        ? "+K"   : "-K")  << ' ';
+        cerr << "+P" << defaults.preludeFileName            << ' ';
+        cerr << (defaults.comRun          ? "+R"   : "-R")  << ' ';
+        cerr << (defaults.tracing         ? "+T"   : "-T")  << ' ';
+        cerr << (defaults.showWarnings    ? "+W"   : "-W")  << ' ';
+        cerr << (defaults.genLLVM    	    ? "+Z"   : "-Z")  << ' ';
         cerr << endl;
         return 0;
     }
 
-    bool success;
-    for (int a = 1; a != argc; ++a)
+    // A server starts once, then compiles for its clients.
+    if (argv[1][0] == '+' && (argv[1][1] == 's' || argv[1][1] == 'S'))
     {
-        success = compile(argv[a]);
-        if (!success)
+        try
+        {
+            serve(argv[1] + 2, compileAndRun);
+        }
+        catch (const Glib::ustring & msg)
+        {
+            cerr << msg;
             return 1;
+        }
+        return 0;
     }
 
+    // A batch compiles its programs in parallel.
+    if (argv[1][0] == '+' && (argv[1][1] == 'j' || argv[1][1] == 'J'))
+        return compileBatch(atoi(argv[1] + 2), vector<string>(argv + 2, argv + argc));
 
-   // Create the JIT.
-  TheExecutionEngine = EngineBuilder(TheModule).create();
-
-  {
-    ExistingModuleProvider OurModuleProvider(TheModule);
-    FunctionPassManager OurFPM(&OurModuleProvider);
-      
-    // Set up the optimizer pipeline.  Start with registering info about how the
-    // target lays out data structures.
-    OurFPM.add(new TargetData(*TheExecutionEngine->getTargetData()));
-    // Promote allocas to registers.
-    OurFPM.add(createPromoteMemoryToRegisterPass());
-    // Do simple "peephole" optimizations and bit-twiddling optzns.
-    OurFPM.add(createInstructionCombiningPass());
-    // Reassociate expressions.
-    OurFPM.add(createReassociatePass());
-    // Eliminate Common SubExpressions.
-    OurFPM.add(createGVNPass());
-    // Simplify the control flow graph (deleting unreachable blocks, etc).
-    OurFPM.add(createCFGSimplificationPass());
-
-    OurFPM.doInitialization();
-
-    // Set the global so the code gen can use this.
-    TheFPM = &OurFPM;
-
-    // Run the main "interpreter loop" now.
-    MainLoop();
-    
-    TheFPM = 0;
-    
-    // Print out all of the generated code.
-    TheModule->dump();
-    
-  }  // Free module provider (and thus the module) and pass manager.
-
-
-
-    return 0;
+    vector<string> outputs;
+    return compileAndRun(vector<string>(argv + 1, argv + argc), outputs);
 }
-
-
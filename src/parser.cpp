@@ -18,21 +18,15 @@
 using namespace std;
 using Glib::ustring;
 
-int Parser::caseTempNum = 0;
-
-Parser::Parser(list<Token> toks) : tokens(toks)
-{
-    // If the parameter name is changed from 'toks' to 'tokens',
-    // the constructor sometimes fails!
-    tki = tokens.begin();
-}
+Parser::Parser(TokenStream & tokens) : tki(tokens)
+{}
 
 void Parser::check(TokenKind kind, ustring message)
 {
     if (tki->kind == kind)
         ++tki;
     else
-        Error() << "Syntax: " << message << '.' << tki->ep << THROW;
+        Error() << "Syntax: " << message << '.' << tki->ep() << THROW;
 }
 
 bool Parser::match(TokenKind kind)
@@ -49,9 +43,9 @@ bool Parser::match(TokenKind kind)
 void Parser::checkIdentifier(ustring message)
 {
     if (tki->keyword)
-        Error() << "Syntax: " << message << "('" << tki->value << "' is a keyword.)" << tki->ep << THROW;
+        Error() << "Syntax: " << message << "('" << tki->value() << "' is a keyword.)" << tki->ep() << THROW;
     else
-        Error() << "Syntax: " << message << tki->ep << THROW;
+        Error() << "Syntax: " << message << tki->ep() << THROW;
 }
 
 void Parser::checkNames(List names, Errpos ep)
@@ -81,7 +75,7 @@ Operator Parser::convOp()
             op = BINOP_MOD;
             break;
         default:
-            Error() << "Syntax: operator expected." << tki->ep << REPORT;
+            Error() << "Syntax: operator expected." << tki->ep() << REPORT;
             break;
     }
     ++tki;
@@ -208,7 +202,12 @@ bool Parser::isArgument()
                                                                                //            };
 Node Parser::parseProgram()
 {
-    Errpos epstart = tki->ep;
+    Errpos epstart = tki->ep();
+    return new ProgramNode(epstart, parseDefinitions());
+}
+
+List Parser::parseDefinitions()
+{
     List nodes;
     while (tki->kind != END_OF_FILE)
     {
@@ -240,7 +239,7 @@ Node Parser::parseProgram()
                 case COLON:
                     {
                         ++tki;
-                        Errpos ep = tki->ep;
+                        Errpos ep = tki->ep();
                         Node type = parseType();
                         check(OP_EQ, "'=' expected or error in definition");
                         Node value = parseExpression();
@@ -252,10 +251,10 @@ Node Parser::parseProgram()
                 case OP_EQ:
                     ++tki;
                     if (isType())
-                        nodes.push_back(new DefNode(tki->ep, name, parseType()));
+                        nodes.push_back(new DefNode(tki->ep(), name, parseType()));
                     else
                     {
-                        Errpos ep = tki->ep;
+                        Errpos ep = tki->ep();
                         switch (tki->kind)
                         {
                             case LB:
@@ -296,7 +295,7 @@ Node Parser::parseProgram()
                 case OP_PLUS_EQ:
                     {
                         ++tki;
-                        Errpos ep = tki->ep;
+                        Errpos ep = tki->ep();
                         switch (tki->kind)
                         {
                             case IDENVAL:
@@ -319,7 +318,7 @@ Node Parser::parseProgram()
                 case LP:
                     {
                         ++tki;
-                        Errpos ep = tki->ep;
+                        Errpos ep = tki->ep();
                         name->setDefining(false);
                         List args;
                         while (isExpression())
@@ -334,7 +333,7 @@ Node Parser::parseProgram()
                     break;
 
                 default:
-                    Error() << "Syntax: illegal declaration." << tki->ep << THROW;
+                    Error() << "Syntax: illegal declaration." << tki->ep() << THROW;
                     break;
             }
         }
@@ -344,7 +343,7 @@ Node Parser::parseProgram()
         if (tki->kind == SEMICOLON)
             ++tki;
     }
-    return new ProgramNode(epstart, nodes);
+    return nodes;
 }
 
 // BasicType -> 'Bool' | 'Integer' | 'Decimal' | 'Float' | 'Text' .
@@ -376,7 +375,7 @@ Node Parser::parseBasicType()
                 result = BaseNode::theUnsignedIntegerNode;
             else
             {
-                Error() << "Type cannot be qualified with 'unsigned'." << tki->ep << REPORT;
+                Error() << "Type cannot be qualified with 'unsigned'." << tki->ep() << REPORT;
                 result = BaseNode::theIntegerNode;
             }
             ++tki;
@@ -425,7 +424,7 @@ Node Parser::parseBasicType()
 //      |  ( BasicType | Name ) [ '[' Expr [ ',' Expr ']' ] | "indexes" Type ]
 Node Parser::parseType()
 {
-    Errpos ep = tki->ep;
+    Errpos ep = tki->ep();
     if (tki->kind == KW_ENUM || tki->kind == OP_LT)
     {
         // Enumerated type
@@ -435,7 +434,7 @@ Node Parser::parseType()
         int position = 0;
         while (tki->kind == IDENVAL)
         {
-            values.push_back(new EnumValueNode(tki->ep, tki->value, position));
+            values.push_back(new EnumValueNode(tki->ep(), tki->symbol, position));
             ++tki;
             ++position;
             if (tki->kind == COMMA)
@@ -484,7 +483,7 @@ Node Parser::parseType()
             return baseType;
     }
     else
-        Error() << "Syntax: error in type definition." << tki->ep << REPORT;
+        Error() << "Syntax: error in type definition." << tki->ep() << REPORT;
 }
 
 
@@ -492,7 +491,7 @@ Node Parser::parseType()
 //      |  ( BasicType | Name ) [ "indexes" Type]
 //Node Parser::parseType()
 //{
-//   Errpos ep = tki->ep;
+//   Errpos ep = tki->ep();
 //   Node result = 0;
 //   if (tki->kind == OP_LT)
 //   {
@@ -502,7 +501,7 @@ Node Parser::parseType()
 //      int position = 0;
 //      while (tki->kind == IDENVAL)
 //      {
-//         values.push_back(new EnumValueNode(tki->ep, tki->value, position));
+//         values.push_back(new EnumValueNode(tki->ep(), tki->value(), position));
 //         ++tki;
 //         ++position;
 //         if (tki->kind == COMMA)
@@ -524,11 +523,11 @@ Node Parser::parseType()
 //            int hi = 0;
 //            if (tki->kind == INTVAL)
 //            {
-//               istringstream is(tki->value);
+//               istringstream is(tki->value());
 //               is >> hi;
 //            }
 //            else
-//               Error() << "Array dimension should be an integer." << tki->ep << REPORT;
+//               Error() << "Array dimension should be an integer." << tki->ep() << REPORT;
 //            ++tki;
 //            check(RB, "error in array declaration.  Missing ']'?");
 //            result = new ArrayTypeNode(ep, result, 0, hi);
@@ -538,7 +537,7 @@ Node Parser::parseType()
 //         // Name of type defined previously
 //         result = parseName(false);
 //      else
-//         Error() << "Syntax: bad type." << tki->ep << REPORT;
+//         Error() << "Syntax: bad type." << tki->ep() << REPORT;
 //
 //      if (tki->kind == KW_INDEXES)
 //      {
@@ -565,8 +564,8 @@ Node Parser::parseCell()
     else if (tki->kind == KW_CELL)
         keywordSyntax = true;
     else
-        Error() << "Syntax: cell expected." << tki->ep << REPORT;
-    Errpos ep = tki->ep;
+        Error() << "Syntax: cell expected." << tki->ep() << REPORT;
+    Errpos ep = tki->ep();
     ++tki;
     List params;
     List instances = parseSlots();
@@ -619,7 +618,7 @@ List Parser::parseSlotDeclaration(bool alias)
             break;
 
         default:
-            Error() << "Syntax: declaration expected." << tki->ep << REPORT;
+            Error() << "Syntax: declaration expected." << tki->ep() << REPORT;
     }
     return result;
 }
@@ -633,8 +632,8 @@ List Parser::parseSlotDeclaration(bool alias)
 List Parser::parseDeclaration(bool defining, MessageKind mk, bool alias)
 {
     if (tki->kind != IDENVAL)
-        Error() << "Parser error: identifier expected." << tki->ep << THROW;
-    Errpos ep = tki->ep;
+        Error() << "Parser error: identifier expected." << tki->ep() << THROW;
+    Errpos ep = tki->ep();
     List names = parseQualifiedNameList(defining, true);
     List result;
     switch (tki->kind)
@@ -679,7 +678,7 @@ List Parser::parseDeclaration(bool defining, MessageKind mk, bool alias)
                         match(OP_DIV_EQ) ||
                         match(OP_MOD_EQ) )
                     {
-                        Error() << "Syntax: operator '" << p.value << "' is not allowed in this context." << p.ep << REPORT;
+                        Error() << "Syntax: operator '" << p.value() << "' is not allowed in this context." << p.ep() << REPORT;
                         ++tki;
                     }
                 }
@@ -806,11 +805,11 @@ List Parser::parseDeclaration(bool defining, MessageKind mk, bool alias)
             {
                 ++tki;
                 if (tki->kind != IDENVAL)
-                    Error() << "Syntax: @ should be followed by 'begin' or 'next'." << tki->ep << REPORT;
+                    Error() << "Syntax: @ should be followed by 'begin' or 'next'." << tki->ep() << REPORT;
                 IterFun fun = ITER_START;
-                if (tki->value == "begin")
+                if (tki->value() == "begin")
                     fun = ITER_START;
-                else if (tki->value == "next")
+                else if (tki->value() == "next")
                     fun = ITER_STEP;
                 else
                     Error() << "Syntax: @ should be followed by 'begin' or 'next'." << ep << REPORT;
@@ -835,7 +834,7 @@ return result;
 // Protocol -> Iden | '[' ( ProtocolSeqence $ '|' ) ']'
 Node Parser::parseProtocol()
 {
-    Errpos ep = tki->ep;
+    Errpos ep = tki->ep();
     if (tki->kind == IDENVAL)
         return parseName(false);
     else if (tki->kind == LB)
@@ -859,7 +858,7 @@ Node Parser::parseProtocol()
 // ProtocolAlternative -> ProtocolSequence $ '|'
 Node Parser::parseProtocolAlternative()
 {
-    Errpos ep = tki->ep;
+    Errpos ep = tki->ep();
     Node seq = parseProtocolSequence();
     if (tki->kind == BAR)
     {
@@ -879,7 +878,7 @@ Node Parser::parseProtocolAlternative()
 // ProtocolSequence -> ProtcolFactor $ ';'
 Node Parser::parseProtocolSequence()
 {
-    Errpos ep = tki->ep;
+    Errpos ep = tki->ep();
     Node fac = parseProtocolFactor();
     if (tki->kind == SEMICOLON)
     {
@@ -904,7 +903,7 @@ Node Parser::parseProtocolSequence()
 Node Parser::parseProtocolFactor()
 {
     Node result = 0;
-    Errpos ep = tki->ep;
+    Errpos ep = tki->ep();
     switch (tki->kind)
     {
         case IDENVAL:
@@ -926,17 +925,17 @@ Node Parser::parseProtocolFactor()
 
         case OP_MUL:
             ++tki;
-            result = new UnopNode(tki->ep, UNOP_MANY, parseProtocolFactor());
+            result = new UnopNode(tki->ep(), UNOP_MANY, parseProtocolFactor());
             break;
 
         case OP_PLUS:
             ++tki;
-            result = new UnopNode(tki->ep, UNOP_MORE, parseProtocolFactor());
+            result = new UnopNode(tki->ep(), UNOP_MORE, parseProtocolFactor());
             break;
 
         case QUEST_MARK:
             ++tki;
-            result = new UnopNode(tki->ep, UNOP_OPT, parseProtocolFactor());
+            result = new UnopNode(tki->ep(), UNOP_OPT, parseProtocolFactor());
             break;
 
         case LP:
@@ -954,8 +953,8 @@ Node Parser::parseProtocolFactor()
 Node Parser::parseCppDec()
 {
     if (tki->kind != KW_CPP)
-        Error() << "Syntax: C++ declartation expected." << tki->ep << REPORT;
-    Errpos ep = tki->ep;
+        Error() << "Syntax: C++ declartation expected." << tki->ep() << REPORT;
+    Errpos ep = tki->ep();
     ++tki;
     List params = parseSlots();
     Node type = 0;
@@ -972,8 +971,8 @@ Node Parser::parseCppDec()
 Node Parser::parseProcedure()
 {
     if (tki->kind != KW_PROCEDURE)
-        Error() << "Syntax: procedure expected." << tki->ep << REPORT;
-    Errpos ep = tki->ep;
+        Error() << "Syntax: procedure expected." << tki->ep() << REPORT;
+    Errpos ep = tki->ep();
     ++tki;
     List slots = parseSlots();
     Node result;
@@ -983,7 +982,7 @@ Node Parser::parseProcedure()
         result = new ProcedureNode(ep, slots, parseSequence());
     }
     else
-        result = new ProcedureNode(ep, slots, new SequenceNode(tki->ep, List()));
+        result = new ProcedureNode(ep, slots, new SequenceNode(tki->ep(), List()));
     check(KW_END, "error in statement or missing 'end'");
     return result;
 }
@@ -994,7 +993,7 @@ Node Parser::parseProcess()
 {
     assert(tki->kind == LC || tki->kind == KW_PROCESS);
     bool keywordSyntax = tki->kind == KW_PROCESS;
-    Errpos ep = tki->ep;
+    Errpos ep = tki->ep();
     ++tki;
     List slots = parseSlots();
     Node result;
@@ -1004,7 +1003,7 @@ Node Parser::parseProcess()
         result = new ProcessNode(ep, slots, parseSequence());
     }
     else
-        result = new ProcessNode(ep, slots, new SequenceNode(tki->ep, List()));
+        result = new ProcessNode(ep, slots, new SequenceNode(tki->ep(), List()));
     if (keywordSyntax)
         check(KW_END, "'end' or '|' missing, or error in statement");
     else
@@ -1015,7 +1014,7 @@ Node Parser::parseProcess()
 // Sequence -> Statement $ ;
 Node Parser::parseSequence()
 {
-    Errpos ep = tki->ep;
+    Errpos ep = tki->ep();
     List seq;
     while (isStatement())
     {
@@ -1045,18 +1044,18 @@ List Parser::parseStatement()
     {
 
         case KW_SKIP:
-            result.push_back(new SkipNode(tki->ep));
+            result.push_back(new SkipNode(tki->ep()));
             ++tki;
             break;
 
         case KW_EXIT:
-            result.push_back(new ExitNode(tki->ep));
+            result.push_back(new ExitNode(tki->ep()));
             ++tki;
             break;
 
         case KW_UNTIL:
             {
-                Errpos ep = tki->ep;
+                Errpos ep = tki->ep();
                 ++tki;
                 Node cond = parseExpression();
                 List stmts;
@@ -1071,7 +1070,7 @@ List Parser::parseStatement()
 
         case KW_WHILE:
             {
-                Errpos ep = tki->ep;
+                Errpos ep = tki->ep();
                 ++tki;
                 Node cond = new UnopNode(ep, UNOP_NOT, parseExpression());
                 List stmts;
@@ -1086,19 +1085,19 @@ List Parser::parseStatement()
 
         case KW_IF:
             {
-                Errpos epstart = tki->ep;
+                Errpos epstart = tki->ep();
                 ++tki;
                 List condPairs;
-                Errpos ep = tki->ep;
+                Errpos ep = tki->ep();
                 Node cond = parseExpression();
                 check(KW_THEN, "bad expression or missing 'then'");
                 condPairs.push_back(new CondPairNode(ep, cond, parseSequence()));
                 while (match(KW_ELIF))
                 {
-                    ep = tki->ep;
+                    ep = tki->ep();
                     Node cond = parseExpression();
                     check(KW_THEN, "bad expression or missing 'then'");
-                    condPairs.push_back(new CondPairNode(tki->ep, cond, parseSequence()));
+                    condPairs.push_back(new CondPairNode(tki->ep(), cond, parseSequence()));
                 }
                 result.push_back(new IfNode(epstart, condPairs, parseAlternative()));
                 break;
@@ -1106,23 +1105,31 @@ List Parser::parseStatement()
 
         case KW_CASES:
             {
-                Errpos epstart = tki->ep;
+                Errpos epstart = tki->ep();
                 ++tki;
                 Node lhs = 0;
                 if (isExpression())
                 {
-                    Errpos ep = tki->ep;
+                    Errpos ep = tki->ep();
                     Node expr = parseExpression();
-                    string tempName = "casetemp" + str(++Parser::caseTempNum);
-                    Node ass = new DecNode(ep, new NameNode(ep, tempName, 0, true), 0, expr,
+                    // When files are parsed in parallel, the temporary is
+                    // named once parsing has finished.
+                    ParseNumbering *numbering = ParseNumbering::current();
+                    string tempName = "casetemp";
+                    if (!numbering)
+                        tempName += str(g_atomic_int_exchange_and_add(&CompilationContext::current().caseTempNum, 1) + 1);
+                    Node tempDef = new NameNode(ep, tempName, 0, true);
+                    Node ass = new DecNode(ep, tempDef, 0, expr,
                                            NO_ROLE, NO_FIELD, true, false, false, false);
                     result.push_back(ass);
                     lhs = new NameNode(ep, tempName, 0, false);
+                    if (numbering)
+                        numbering->addCaseTemp(tempDef, lhs);
                 }
                 List condPairs;
                 while (match(BAR))
                 {
-                    Errpos ep = tki->ep;
+                    Errpos ep = tki->ep();
                     Node rhs = 0;
                     if (isExpression())
                         rhs = parseExpression();
@@ -1130,9 +1137,9 @@ List Parser::parseStatement()
                     if (rhs)
                         cond = lhs ? new BinopNode(ep, BINOP_EQ, lhs, rhs) : rhs;
                     else
-                        cond = new BoolNode(Errpos(tki->ep), true);
+                        cond = new BoolNode(Errpos(tki->ep()), true);
                     check(BAR, "error in guard or '|' missing");
-                    condPairs.push_back(new CondPairNode(tki->ep, cond, parseSequence()));
+                    condPairs.push_back(new CondPairNode(tki->ep(), cond, parseSequence()));
                 }
                 result.push_back(new IfNode(epstart, condPairs, new SequenceNode(epstart, List())));
                 check(KW_END, "'end' missing (possibly in an inner scope)");
@@ -1141,7 +1148,7 @@ List Parser::parseStatement()
 
         case KW_LOOP:
             {
-                Errpos ep = tki->ep;
+                Errpos ep = tki->ep();
                 ++tki;
                 result.push_back(new LoopNode(ep, parseSequence()));
                 check(KW_END, "'end' missing (possibly in inner scope)");
@@ -1150,7 +1157,7 @@ List Parser::parseStatement()
 
         case KW_FOR:
             {
-                Errpos ep = tki->ep;
+                Errpos ep = tki->ep();
                 ++tki;
                 Node comp = parseComprehension();
                 check(KW_DO, "'do' expected");
@@ -1162,7 +1169,7 @@ List Parser::parseStatement()
 
         case KW_ANY:
             {
-                Errpos ep = tki->ep;
+                Errpos ep = tki->ep();
                 ++tki;
                 Node comp = parseComprehension();
                 check(KW_DO, "'do' expected");
@@ -1186,7 +1193,7 @@ List Parser::parseStatement()
 
         case KW_START:
             {
-                Errpos ep = tki->ep;
+                Errpos ep = tki->ep();
                 ++tki;
                 List calls;
                 while (tki->kind == IDENVAL)
@@ -1203,12 +1210,12 @@ List Parser::parseStatement()
 
         case IDENVAL:
             {
-                if (  tki->value == "assert" ||
-                    tki->value == "file_close" ||
-                    tki->value == "file_write" )
+                if (  tki->value() == "assert" ||
+                    tki->value() == "file_close" ||
+                    tki->value() == "file_write" )
                 {
-                    Node name = new NameNode(tki->ep, tki->value, 0, false);
-                    Errpos ep = tki->ep;
+                    Node name = new NameNode(tki->ep(), tki->symbol, 0, false);
+                    Errpos ep = tki->ep();
                     ++tki;
                     List args;
                     if (tki->kind == LP)
@@ -1240,13 +1247,13 @@ List Parser::parseStatement()
 //           { '|' [ Disjunction ] '|' Sequence }
 Node Parser::parseSelect(const bool loop)
 {
-    Errpos eps = tki->ep;
+    Errpos eps = tki->ep();
     ++tki;
     List options;
     Policy pol = parsePolicy();
     while (tki->kind == BAR)
     {
-        Errpos ep = tki->ep;
+        Errpos ep = tki->ep();
         ++tki;
 
         // Guard
@@ -1319,7 +1326,7 @@ Node Parser::parseAlternative()
     if (match(KW_ELSE))
         result = parseSequence();
     else
-        result = new SequenceNode(tki->ep, List());
+        result = new SequenceNode(tki->ep(), List());
     check(KW_END, "bad statement or missing 'end'");
     return result;
 }
@@ -1327,7 +1334,7 @@ Node Parser::parseAlternative()
 // Comprehension -> Var [ ':' Type ] 'in' Set [ 'such' 'that' Expr ]
 Node Parser::parseComprehension()
 {
-    Errpos ep = tki->ep;
+    Errpos ep = tki->ep();
     Node var = parseName(true);
     Node type = 0;
     if (tki->kind == COLON)
@@ -1341,14 +1348,14 @@ Node Parser::parseComprehension()
     else
         collection = new EnumSetNode(ep, type);
     Node pred = 0;
-    Errpos epSuch = tki->ep;
+    Errpos epSuch = tki->ep();
     if (tki->kind == KW_SUCH)
     {
         ++tki;
         if (tki->kind == KW_THAT)
             ++tki;
         else
-            cerr << "Warning: 'that' inserted after 'such'." << epSuch;
+            CompilationContext::current().diagnostics() << "Warning: 'that' inserted after 'such'." << epSuch;
         pred = parseExpression();
     }
     return new ComprehensionNode(ep, var, type, collection, pred);
@@ -1373,7 +1380,7 @@ Node Parser::parseStep()
 
 Node Parser::parseCollection(Node type)
 {
-    Errpos ep = tki->ep;
+    Errpos ep = tki->ep();
     if (tki->kind == KW_DOMAIN)
     {
         ++tki;
@@ -1417,7 +1424,7 @@ Node Parser::parseCollection(Node type)
                 open = true;
             }
             else
-                Error() << "Syntax: '<' or '<=' expected." << tki->ep << REPORT;
+                Error() << "Syntax: '<' or '<=' expected." << tki->ep() << REPORT;
             Node finish = parseSum();
             return new RangeNode(ep, type, start, finish, step, open, true);
         }
@@ -1437,7 +1444,7 @@ Node Parser::parseCollection(Node type)
                 open = true;
             }
             else
-                Error() << "Syntax: '<' or '<=' expected." << tki->ep << REPORT;
+                Error() << "Syntax: '<' or '<=' expected." << tki->ep() << REPORT;
             Node finish = parseSum();
             return new RangeNode(ep, type, start, finish, step, open, false);
         }
@@ -1445,7 +1452,7 @@ Node Parser::parseCollection(Node type)
             return new EnumSetNode(ep, start);
     }
     else
-        Error() << "Syntax: set expression expected." << tki->ep << REPORT;
+        Error() << "Syntax: set expression expected." << tki->ep() << REPORT;
 }
 
 // Expression = CondExpr $ '//'
@@ -1454,7 +1461,7 @@ Node Parser::parseExpression()
     Node result = parseConditionalExpression();
     while (tki->kind == OP_CAT)
     {
-        Errpos ep = tki->ep;
+        Errpos ep = tki->ep();
         ++tki;
         result = new BinopNode(ep, BINOP_CAT, result, parseConditionalExpression());
     }
@@ -1464,7 +1471,7 @@ Node Parser::parseExpression()
 // ConditionalExpression = Disjunction [ 'if' Disjunction 'else' Disjunction ]
 Node Parser::parseConditionalExpression()
 {
-    Errpos ep = tki->ep;
+    Errpos ep = tki->ep();
     Node lhs = parseDisjunction();
     if (tki->kind == KW_IF)
     {
@@ -1484,7 +1491,7 @@ Node Parser::parseDisjunction()
     Node result = parseConjunction();
     while (tki->kind == KW_OR)
     {
-        Errpos ep = tki->ep;
+        Errpos ep = tki->ep();
         ++tki;
         result = new BinopNode(ep, BINOP_OR, result, parseConjunction());
     }
@@ -1497,7 +1504,7 @@ Node Parser::parseConjunction()
     Node result = parseComparison();
     while (tki->kind == KW_AND)
     {
-        Errpos ep = tki->ep;
+        Errpos ep = tki->ep();
         ++tki;
         result = new BinopNode(ep, BINOP_AND, result, parseComparison());
     }
@@ -1508,7 +1515,7 @@ Node Parser::parseConjunction()
 Node Parser::parseComparison()
 {
     Node result = parseOrdering();
-    Errpos ep = tki->ep;
+    Errpos ep = tki->ep();
     switch (tki->kind)
     {
         case OP_EQ:
@@ -1531,7 +1538,7 @@ Node Parser::parseComparison()
 Node Parser::parseOrdering()
 {
     Node result = parseSum();
-    Errpos ep = tki->ep;
+    Errpos ep = tki->ep();
     switch (tki->kind)
     {
         case OP_LT:
@@ -1566,7 +1573,7 @@ Node Parser::parseSum()
     Node result = parseProduct();
     while (tki->kind == OP_PLUS || tki->kind == OP_MINUS)
     {
-        Errpos ep = tki->ep;
+        Errpos ep = tki->ep();
         Operator op;
         switch (tki->kind)
         {
@@ -1595,7 +1602,7 @@ Node Parser::parseProduct()
            tki->kind == KW_REM ||
            tki->kind == KW_MOD)
     {
-        Errpos ep = tki->ep;
+        Errpos ep = tki->ep();
         Operator op;
         switch (tki->kind)
         {
@@ -1635,43 +1642,43 @@ Node Parser::parseProduct()
 //        |  '(' Expression ')'
 Node Parser::parseFactor()
 {
-    Errpos eps = tki->ep;
+    Errpos eps = tki->ep();
     //   cerr << "Factor " << eps << endl;
     Node result = 0;
     switch (tki->kind)
     {
         case KW_TRUE:
-            result = new BoolNode(Errpos(tki->ep), true);
+            result = new BoolNode(Errpos(tki->ep()), true);
             ++tki;
             break;
 
         case KW_FALSE:
-            result = new BoolNode(Errpos(tki->ep), false);
+            result = new BoolNode(Errpos(tki->ep()), false);
             ++tki;
             break;
 
         case KW_EXECUTE:
             ++tki;
-            result = new UnopNode(Errpos(tki->ep), UNOP_EXECUTE, parseFactor());
+            result = new UnopNode(Errpos(tki->ep()), UNOP_EXECUTE, parseFactor());
             break;
 
         case CHARVAL:
-            result = new CharNode(Errpos(tki->ep), tki->value[0]);
+            result = new CharNode(Errpos(tki->ep()), tki->value()[0]);
             ++tki;
             break;
 
         case TEXTVAL:
-            result = new TextNode(Errpos(tki->ep), tki->value);
+            result = new TextNode(Errpos(tki->ep()), tki->value());
             ++tki;
             break;
 
         case INTVAL:
-            result = new NumNode(Errpos(tki->ep), BaseNode::theIntegerNode, tki->value);
+            result = new NumNode(Errpos(tki->ep()), BaseNode::theIntegerNode, tki->value());
             ++tki;
             break;
 
         case DECIMALVAL:
-            result = new NumNode(Errpos(tki->ep), BaseNode::theDecimalNode, tki->value);
+            result = new NumNode(Errpos(tki->ep()), BaseNode::theDecimalNode, tki->value());
             ++tki;
             break;
 
@@ -1683,7 +1690,7 @@ Node Parser::parseFactor()
 
         case KW_NOT:
             ++tki;
-            result = new UnopNode(Errpos(tki->ep), UNOP_NOT, parseFactor());
+            result = new UnopNode(Errpos(tki->ep()), UNOP_NOT, parseFactor());
             break;
 
         case OP_MINUS:
@@ -1696,13 +1703,13 @@ Node Parser::parseFactor()
                     result = fac;
                 }
                 else
-                    result = new UnopNode(Errpos(tki->ep), UNOP_MINUS, fac);
+                    result = new UnopNode(Errpos(tki->ep()), UNOP_MINUS, fac);
             }
             break;
 
         case OP_SHARP:
             {
-                Errpos ep = tki->ep;
+                Errpos ep = tki->ep();
                 ++tki;
                 if (isArgument())
                 {
@@ -1723,13 +1730,13 @@ Node Parser::parseFactor()
                     result = new FunctionNode(ep, new NameNode(ep, "#", 0, false), args);
                 }
                 else
-                    Error() << "Syntax: # requires a right operand." << tki->ep << REPORT;
+                    Error() << "Syntax: # requires a right operand." << tki->ep() << REPORT;
             }
             break;
 
         case IDENVAL:
             {
-                Errpos ep = tki->ep;
+                Errpos ep = tki->ep();
                 result = parseQualifiedName();
                 if (isArgument())
                 {
@@ -1753,16 +1760,16 @@ Node Parser::parseFactor()
                 {
                     ++tki;
                     if (tki->kind != IDENVAL)
-                        Error() << "Syntax: @ should be followed by 'finish', 'key', or 'value'." << tki->ep << REPORT;
+                        Error() << "Syntax: @ should be followed by 'finish', 'key', or 'value'." << tki->ep() << REPORT;
                     IterFun fun = ITER_FINISH;
-                    if (tki->value == "finish")
+                    if (tki->value() == "finish")
                         fun = ITER_FINISH;
-                    else if (tki->value == "key")
+                    else if (tki->value() == "key")
                         fun = ITER_KEY;
-                    else if (tki->value == "value")
+                    else if (tki->value() == "value")
                         fun = ITER_VALUE;
                     else
-                        Error() << "Syntax: @ should be followed by 'finish', 'key', or 'value'." << tki->ep << REPORT;
+                        Error() << "Syntax: @ should be followed by 'finish', 'key', or 'value'." << tki->ep() << REPORT;
                     ++tki;
                     result = new IteratorNode(ep, result, fun);
                     break;
@@ -1793,7 +1800,7 @@ List Parser::parseQualifiedNameList(bool definition, bool lvalue)
 // CompoundName -> Name { '[' Sum [ '..' Sum ] ']' } [ '.' Iden ]
 Node Parser::parseQualifiedName(bool definition, bool lvalue)
 {
-    Errpos ep = tki->ep;
+    Errpos ep = tki->ep();
     Node result = parseName(definition);
     while (match(LB))
     {
@@ -1816,7 +1823,7 @@ Node Parser::parseName(bool definition)
 {
     if (tki->kind == IDENVAL)
     {
-        Node p = new NameNode(tki->ep, tki->value, 0, definition);
+        Node p = new NameNode(tki->ep(), tki->symbol, 0, definition);
         ++tki;
         return p;
     }
@@ -1828,7 +1835,7 @@ Node Parser::parseName(bool definition)
 Node Parser::parseThread()
 {
     assert(tki->kind == KW_THREAD);
-    Errpos ep = tki->ep;
+    Errpos ep = tki->ep();
     Node port = new NameNode(ep, "ch", 0, false);
     ++tki;
     List inputs = parseParamList(port, true);
@@ -1845,7 +1852,7 @@ Node Parser::parseThread()
         result = new ThreadNode(ep, port, inputs, outputs, parseSequence());
     }
     else
-        result =  new ThreadNode(ep, port, inputs, outputs, new SequenceNode(tki->ep, List()));
+        result =  new ThreadNode(ep, port, inputs, outputs, new SequenceNode(tki->ep(), List()));
     check(KW_END, "missing 'end', missing '|', or error in statement");
     return result;
 }
@@ -1882,7 +1889,7 @@ List Parser::parseParamList(Node port, bool input)
 Node Parser::parseThreadCall()
 {
     assert(tki->kind == IDENVAL);
-    Errpos ep = tki->ep;
+    Errpos ep = tki->ep();
     Node name = parseName(false);
     check(LP, "'(' expected in thread invocation");
           List inputs;
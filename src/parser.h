@@ -16,14 +16,14 @@ using namespace std;
 
 class Token;
 
-/** A parser accepts a list of tokens and builds an abstract syntax tree. */
+/** A parser accepts a stream of tokens and builds an abstract syntax tree. */
 class Parser
 {
     public:
 
         /** Construct a parser.
          * \param tokens provides the input for the parser. */
-        Parser(list<Token> tokens);
+        Parser(TokenStream & tokens);
 
 
         /** Check that an expected token is actually there.
@@ -74,6 +74,9 @@ class Parser
         /** Parse an entire program (list of type definitions). */
         Node parseProgram();
 
+        /** Parse the top-level definitions of one or more files. */
+        List parseDefinitions();
+
         /** Parse a list of qualified names. */
         List parseQualifiedNameList(bool definition, bool lvalue);
 
@@ -196,14 +199,10 @@ class Parser
 
     private:
 
-        /** The list of tokens to be parsed. */
-        list<Token> tokens;
-
-        /** A global iterator for the token list. */
-        list<Token>::const_iterator tki;
-
-        /** Counter for temporary expressions generated for 'cases' statements. */
-        static int caseTempNum;
+        /** The tokens to be parsed: tki-> is the current token
+         *  and ++tki moves to the next.
+         */
+        TokenStream & tki;
 };
 
 #endif
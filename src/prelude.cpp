@@ -1,4 +1,4 @@
-// Version 44
+// Version 45
 //*A
 #include <cassert>
 #include <cstdlib>
@@ -12,9 +12,17 @@
 #include <time.h>
 using namespace std;
 
+// When the prelude is compiled as the run-time library (libmert.a or
+// mert.bc), the helpers must have external definitions.
+#ifdef MEC_RUNTIME
+#define MEC_INLINE
+#else
+#define MEC_INLINE inline
+#endif
+
 //--------------------------------------------------------------------  to bool
 
-inline bool string2bool(string s)
+MEC_INLINE bool string2bool(string s)
 {
    if (s == "true")
       return true;
@@ -27,7 +35,7 @@ inline bool string2bool(string s)
 
 //---------------------------------------------------------------------- to byte
 
-inline char int2byte(int i)
+MEC_INLINE char int2byte(int i)
 {
    if (-128 <= i && i < 128)
       return static_cast<char>(i);
@@ -35,7 +43,7 @@ inline char int2byte(int i)
    return 0;
 }
 
-inline char ubyte2byte(unsigned char ub)
+MEC_INLINE char ubyte2byte(unsigned char ub)
 {
    if (ub < 128)
       return static_cast<char>(ub);
@@ -43,7 +51,7 @@ inline char ubyte2byte(unsigned char ub)
    return 0;
 }
 
-inline char uint2byte(unsigned int ui)
+MEC_INLINE char uint2byte(unsigned int ui)
 {
    if (ui < 128)
       return static_cast<char>(ui);
@@ -53,7 +61,7 @@ inline char uint2byte(unsigned int ui)
 
 //------------------------------------------------------------- to unsigned byte
 
-inline unsigned char byte2ubyte(char c)
+MEC_INLINE unsigned char byte2ubyte(char c)
 {
    if (c >= 0)
       return static_cast<unsigned char>(c);
@@ -61,7 +69,7 @@ inline unsigned char byte2ubyte(char c)
    return 0;
 }
 
-inline unsigned char int2ubyte(int i)
+MEC_INLINE unsigned char int2ubyte(int i)
 {
    if (0 <= i && i < 256)
       return static_cast<unsigned char>(i);
@@ -69,7 +77,7 @@ inline unsigned char int2ubyte(int i)
    return 0;
 }
 
-inline unsigned char uint2ubyte(unsigned int ui)
+MEC_INLINE unsigned char uint2ubyte(unsigned int ui)
 {
    if (0 <= ui && ui < 256)
       return static_cast<unsigned char>(ui);
@@ -80,7 +88,7 @@ inline unsigned char uint2ubyte(unsigned int ui)
 //--------------------------------------------------------------------  to char
 
 // Convert integer to ASCII character
-inline char encode2char(int i)
+MEC_INLINE char encode2char(int i)
 {
    if (0 <= i && i < 256)
       return static_cast<char>(i);
@@ -88,7 +96,7 @@ inline char encode2char(int i)
    return ' ';
 }
 
-inline char string2char(string s)
+MEC_INLINE char string2char(string s)
 {
    if (s.length() == 1)
       return s[0];
@@ -99,12 +107,12 @@ inline char string2char(string s)
 
 //-------------------------------------------------------------------- to string
 
-inline string bool2string1(bool b)
+MEC_INLINE string bool2string1(bool b)
 {
    return b ? "true" : "false";
 }
 
-inline string bool2string2(bool b, int width)
+MEC_INLINE string bool2string2(bool b, int width)
 {
    ostringstream os;
    if (width < 0)
@@ -119,12 +127,12 @@ inline string bool2string2(bool b, int width)
    return os.str();
 }
 
-inline string char2string1(char c)
+MEC_INLINE string char2string1(char c)
 {
    return string(1, c);
 }
 
-inline string char2string2(char c, int width)
+MEC_INLINE string char2string2(char c, int width)
 {
    ostringstream os;
    if (width < 0)
@@ -136,7 +144,7 @@ inline string char2string2(char c, int width)
    return os.str();
 }
 
-inline string string2string2(string s, int width)
+MEC_INLINE string string2string2(string s, int width)
 {
    ostringstream os;
    if (width < 0)
@@ -148,21 +156,21 @@ inline string string2string2(string s, int width)
    return os.str();
 }
 
-inline string int2string1(int i)
+MEC_INLINE string int2string1(int i)
 {
    ostringstream os;
    os << i;
    return os.str();
 }
 
-inline string uint2string1(unsigned int ui)
+MEC_INLINE string uint2string1(unsigned int ui)
 {
    ostringstream os;
    os << ui;
    return os.str();
 }
 
-inline string int2string2(int i, int width)
+MEC_INLINE string int2string2(int i, int width)
 {
    ostringstream os;
    if (width < 0)
@@ -174,7 +182,7 @@ inline string int2string2(int i, int width)
    return os.str();
 }
 
-inline string uint2string2(unsigned int i, int width)
+MEC_INLINE string uint2string2(unsigned int i, int width)
 {
    ostringstream os;
    if (width < 0)
@@ -186,24 +194,24 @@ inline string uint2string2(unsigned int i, int width)
    return os.str();
 }
 
-inline string byte2string1(char b)
+MEC_INLINE string byte2string1(char b)
 {
    return int2string1(b);
 }
 
-inline string ubyte2string1(unsigned char ub)
+MEC_INLINE string ubyte2string1(unsigned char ub)
 {
    return uint2string1(ub);
 }
 
-inline string double2string1(double d)
+MEC_INLINE string double2string1(double d)
 {
    ostringstream os;
    os << d;
    return os.str();
 }
 
-inline string double2string2(double d, int width)
+MEC_INLINE string double2string2(double d, int width)
 {
    ostringstream os;
    if (width < 0)
@@ -215,7 +223,7 @@ inline string double2string2(double d, int width)
    return os.str();
 }
 
-inline string double2string3(double d, int width, int prec)
+MEC_INLINE string double2string3(double d, int width, int prec)
 {
    ostringstream os;
    if (width < 0)
@@ -230,7 +238,7 @@ inline string double2string3(double d, int width, int prec)
 //----------------------------------------------------------------------- to int
 
 // Return the integer in [0,9] corresponding to a character.
-inline int char2int(char c)
+MEC_INLINE int char2int(char c)
 {
    if ('0' <= c && c <= '9')
       return c - '0';
@@ -239,12 +247,12 @@ inline int char2int(char c)
 }
 
 // Return the ASCII code of a character.
-inline int char2decode(char c)
+MEC_INLINE int char2decode(char c)
 {
    return c;
 }
 
-inline int string2int(string s)
+MEC_INLINE int string2int(string s)
 {
    istringstream is(s);
    int i;
@@ -253,21 +261,21 @@ inline int string2int(string s)
 }
 
 // Check enumeration value
-inline int check_enum_val(int val, int max)
+MEC_INLINE int check_enum_val(int val, int max)
 {
    if (0 <= val && val < max)
       return val;
    cerr << "Illegal enumeration value: " << val << endl;
 }
 
-inline int stringlen(string s)
+MEC_INLINE int stringlen(string s)
 {
    return int(s.size());
 }
 
 // ------------------------------------------------------------- to unsigned int
 
-inline unsigned int int2uint(int val)
+MEC_INLINE unsigned int int2uint(int val)
 {
    if (val >= 0)
       return static_cast<unsigned int>(val);
@@ -276,29 +284,29 @@ inline unsigned int int2uint(int val)
 
 // ------------------------------------------------ New conversions (2008/12/27)
 
-inline bool isInteger(double d)
+MEC_INLINE bool isInteger(double d)
 {
    return static_cast<double>(static_cast<int>(d)) == d;
 }
 
-inline int double2floor(double d)
+MEC_INLINE int double2floor(double d)
 {
    return d >= 0.0 || isInteger(d) ? static_cast<int>(d) : static_cast<int>(d - 1.0);
 }
 
-inline int double2round(double d)
+MEC_INLINE int double2round(double d)
 {
    return d >= 0.0 ? static_cast<int>(d + 0.5) : static_cast<int>(d - 0.5);
 }
 
-inline int double2ceiling(double d)
+MEC_INLINE int double2ceiling(double d)
 {
    return d < 0.0 || isInteger(d) ? static_cast<int>(d) : static_cast<int>(d + 1.0);
 }
 
 //-------------------------------------------------------------------- to double
 
-inline double string2double(string s)
+MEC_INLINE double string2double(string s)
 {
    istringstream is(s);
    double d;
@@ -700,9 +708,39 @@ struct Select
 
 string sourceLine = "";
 
+#ifdef MEC_RUNTIME
+// A process whose code was generated by 'mec +Z' or 'mec +R'.  Each
+// activation runs it from its pc to its next unlock point; it returns
+// nonzero if the process is to be activated again.
+struct CompiledProcess : public Process
+{
+   CompiledProcess(const char *n, int (*activate)(Process *)) : activate(activate)
+   {
+      name = n;
+   }
+   void do_actions()
+   {
+      if (!activate(this))
+         remove(readyQueue);
+   }
+   int (*activate)(Process *);
+};
+
+// Create a top-level process: called by the generated main()
+// before mert_run().
+extern "C" void mert_spawn(const char *name, int (*activate)(Process *))
+{
+   put(readyQueue, new CompiledProcess(name, activate));
+}
+#endif
+
 //*B
 
+#ifdef MEC_RUNTIME
+extern "C" int mert_run()
+#else
 int main()
+#endif
 {
 //*C
    Process *p;
@@ -720,9 +758,11 @@ int main()
          readyQueue = readyQueue->next;
          p = first(readyQueue);
 //*E
+#ifndef MEC_RUNTIME
          p->report(sourceLine);
          if (--cycles == 0)
             break;
+#endif
 //*F
          p->do_actions();
       }
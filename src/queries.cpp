@@ -175,9 +175,9 @@ FileMode BaseNode::checkSysIO() const
 
 FileMode DotNode::checkSysIO() const
 {
-    if (port->getNameString() == BASIO_SYS)
+    if (port->getSymbol() == BASIO_SYS)
     {
-        string fieldName = field->getNameString();
+        Symbol fieldName = field->getSymbol();
         if (fieldName == BASIO_INP)
             return SYS_IN;
         else if (fieldName == BASIO_OUT)
@@ -193,9 +193,9 @@ FileMode DotNode::checkSysIO() const
 
 FileMode QueryNode::checkSysIO() const
 {
-    if (port->getNameString() == BASIO_SYS)
+    if (port->getSymbol() == BASIO_SYS)
     {
-        string fieldName = field->getNameString();
+        Symbol fieldName = field->getSymbol();
         if (fieldName == BASIO_INP)
             return SYS_IN;
         else if (fieldName == BASIO_OUT)
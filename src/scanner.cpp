@@ -17,125 +17,277 @@
 using namespace std;
 using namespace Glib::Unicode;
 
-Scanner::Scanner()
+/** Character classes used by the scanner.  Each byte of the source
+ *  is classified by a table lookup; bytes with the top bit set start
+ *  or continue a UTF-8 sequence and are decoded only where needed.
+ */
+enum CharClass
 {
-    // Types
-    keywords["Bool"]        = KW_BOOL;
-    keywords["Boolean"]     = KW_BOOL;
-    keywords["Byte"]        = KW_BYTE;
-    keywords["Decimal"]     = KW_DECIMAL;
-    keywords["enum"]        = KW_ENUM;
-    keywords["enumeration"] = KW_ENUM;
-    keywords["Float"]       = KW_FLOAT;
-    keywords["Int"]         = KW_INTEGER;
-    keywords["Integer"]     = KW_INTEGER;
-    keywords["Char"]        = KW_CHAR;
-    keywords["Character"]   = KW_CHAR;
-    keywords["Text"]        = KW_TEXT;
-    keywords["InputFile"]   = KW_INPUT_FILE;
-    keywords["OutputFile"]  = KW_OUTPUT_FILE;
-    keywords["Void"]        = KW_VOID;
-    keywords["unsigned"]    = KW_UNSIGNED;
-
-    // Keywords
-    keywords["alias"]      = KW_ALIAS;
-    keywords["and"]        = KW_AND;
-    keywords["any"]        = KW_ANY;
-
-    keywords["cases"]      = KW_CASES;
-    keywords["cpp"]        = KW_CPP;
-    keywords["cell"]       = KW_CELL;
-    keywords["copy"]       = KW_COPY;
-
-    keywords["div"]        = KW_DIV;
-    keywords["do"]         = KW_DO;
-    keywords["domain"]     = KW_DOMAIN;
-
-    keywords["elif"]       = KW_ELIF;
-    keywords["else"]       = KW_ELSE;
-    keywords["end"]        = KW_END;
-    keywords["execute"]    = KW_EXECUTE;
-    keywords["exit"]       = KW_EXIT;
-
-    keywords["fair"]       = KW_FAIR;
-    keywords["false"]      = KW_FALSE;
-    keywords["for"]        = KW_FOR;
-
-    keywords["if"]         = KW_IF;
-    keywords["import"]     = KW_IMPORT;
-    keywords["in"]         = KW_IN;
-    keywords["indexes"]    = KW_INDEXES;
-
-    keywords["loop"]       = KW_LOOP;
-    keywords["loopselect"] = KW_LOOPSELECT;
+    CC_OTHER,   // Operators, punctuation, quotes, control characters
+    CC_SPACE,   // White space within a line
+    CC_LETTER,  // A-Z, a-z
+    CC_DIGIT,   // 0-9
+    CC_HIGH     // Part of a multibyte UTF-8 character
+};
+
+/** The class of each byte value. */
+static struct CharClassTable
+{
+    CharClassTable()
+    {
+        for (int c = 0; c < 256; ++c)
+        {
+            if (c >= 0x80)
+                cls[c] = CC_HIGH;
+            else if (isdigit(c))
+                cls[c] = CC_DIGIT;
+            else if (isalpha(c))
+                cls[c] = CC_LETTER;
+            else if (c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v')
+                cls[c] = CC_SPACE;
+            else
+                cls[c] = CC_OTHER;
+        }
+    }
 
-    keywords["mod"]        = KW_MOD;
+    CharClass operator[](char c) const
+    {
+        return CharClass(cls[static_cast<unsigned char>(c)]);
+    }
 
-    keywords["not"]        = KW_NOT;
+    unsigned char cls[256];
+}
+charClass;
 
-    keywords["or"]         = KW_OR;
-    keywords["ordered"]    = KW_ORDERED;
+/** Return the byte at \a p, or '\\0' at the end of the line \a eol. */
+static inline char at(const char *p, const char *eol)
+{
+    return p < eol ? *p : '\0';
+}
 
-    keywords["procedure"]  = KW_PROCEDURE;
-    keywords["process"]    = KW_PROCESS;
-    keywords["protocol"]   = KW_PROTOCOL;
+/** If \a p starts a letter (or, with \a alnum, a letter or digit) that is
+ *  not ASCII, return the address of the next character, otherwise \a p.
+ */
+static const char *skipUnicode(const char *p, const char *eol, bool alnum)
+{
+    gunichar c = g_utf8_get_char_validated(p, eol - p);
+    if (c == gunichar(-1) || c == gunichar(-2))
+        return p;
+    if (alnum ? g_unichar_isalnum(c) : g_unichar_isalpha(c))
+        return g_utf8_next_char(p);
+    return p;
+}
 
-    keywords["random"]     = KW_RANDOM;
-    keywords["range"]      = KW_RANGE;
-    keywords["rem"]        = KW_REM;
+/** A keyword and the kind of token it makes. */
+struct Keyword
+{
+    const char *text;
+    size_t length;
+    TokenKind kind;
+};
 
-    keywords["select"]     = KW_SELECT;
-    keywords["share"]      = KW_SHARE;
-    keywords["skip"]       = KW_SKIP;
-    keywords["start"]      = KW_START;
-    keywords["step"]       = KW_STEP;
-    keywords["such"]       = KW_SUCH;
+/** The keywords.  Entries are numbered from 1, in this order, by keywordSlots. */
+static const Keyword keywordList[] =
+{
+    // Types
+    { "Bool",         4, KW_BOOL },
+    { "Boolean",      7, KW_BOOL },
+    { "Byte",         4, KW_BYTE },
+    { "Decimal",      7, KW_DECIMAL },
+    { "enum",         4, KW_ENUM },
+    { "enumeration", 11, KW_ENUM },
+    { "Float",        5, KW_FLOAT },
+    { "Int",          3, KW_INTEGER },
+    { "Integer",      7, KW_INTEGER },
+    { "Char",         4, KW_CHAR },
+    { "Character",    9, KW_CHAR },
+    { "Text",         4, KW_TEXT },
+    { "InputFile",    9, KW_INPUT_FILE },
+    { "OutputFile",  10, KW_OUTPUT_FILE },
+    { "Void",         4, KW_VOID },
+    { "unsigned",     8, KW_UNSIGNED },
 
-    keywords["that"]       = KW_THAT;
-    keywords["then"]       = KW_THEN;
-    keywords["thread"]     = KW_THREAD;
-    keywords["to"]         = KW_TO;
-    keywords["true"]       = KW_TRUE;
+    // Keywords
+    { "alias",        5, KW_ALIAS },
+    { "and",          3, KW_AND },
+    { "any",          3, KW_ANY },
+    { "cases",        5, KW_CASES },
+    { "cpp",          3, KW_CPP },
+    { "cell",         4, KW_CELL },
+    { "copy",         4, KW_COPY },
+    { "div",          3, KW_DIV },
+    { "do",           2, KW_DO },
+    { "domain",       6, KW_DOMAIN },
+    { "elif",         4, KW_ELIF },
+    { "else",         4, KW_ELSE },
+    { "end",          3, KW_END },
+    { "execute",      7, KW_EXECUTE },
+    { "exit",         4, KW_EXIT },
+    { "fair",         4, KW_FAIR },
+    { "false",        5, KW_FALSE },
+    { "for",          3, KW_FOR },
+    { "if",           2, KW_IF },
+    { "import",       6, KW_IMPORT },
+    { "in",           2, KW_IN },
+    { "indexes",      7, KW_INDEXES },
+    { "loop",         4, KW_LOOP },
+    { "loopselect",  10, KW_LOOPSELECT },
+    { "mod",          3, KW_MOD },
+    { "not",          3, KW_NOT },
+    { "or",           2, KW_OR },
+    { "ordered",      7, KW_ORDERED },
+    { "procedure",    9, KW_PROCEDURE },
+    { "process",      7, KW_PROCESS },
+    { "protocol",     8, KW_PROTOCOL },
+    { "random",       6, KW_RANDOM },
+    { "range",        5, KW_RANGE },
+    { "rem",          3, KW_REM },
+    { "select",       6, KW_SELECT },
+    { "share",        5, KW_SHARE },
+    { "skip",         4, KW_SKIP },
+    { "start",        5, KW_START },
+    { "step",         4, KW_STEP },
+    { "such",         4, KW_SUCH },
+    { "that",         4, KW_THAT },
+    { "then",         4, KW_THEN },
+    { "thread",       6, KW_THREAD },
+    { "to",           2, KW_TO },
+    { "true",         4, KW_TRUE },
+    { "until",        5, KW_UNTIL },
+    { "while",        5, KW_WHILE }
+};
+
+/** Size of the keyword hash table. */
+const unsigned KEYWORD_SLOTS = 197;
+
+/** Perfect hash table for the keywords: entry h holds 1 + the index in
+ * keywordList of the only keyword whose hash is h, or 0 if there is none.
+ * keywordHash() has no collisions for the keywords above; when a keyword
+ * is added, its slot must be free or the multipliers must be changed.
+ */
+static const unsigned char keywordSlots[KEYWORD_SLOTS] =
+{
+     0,  0, 29,  0,  0,  2,  0,  0, 37,  0,  0,  0,  0,  0,  0,  0,  0,  0, 52,  0,
+     0, 35, 33, 22,  0,  0, 61,  0,  0,  0,  0, 36,  0, 60,  0,  0, 21, 62,  0,  0,
+    44,  0,  0, 38,  0, 42, 26,  0, 25, 59,  0,  0,  0,  0,  0, 18,  0,  5, 51, 56,
+    49,  0,  0,  0,  0,  0,  0,  9,  0,  0,  6, 15, 31,  0, 23,  8,  0,  0,  0,  0,
+     0,  0,  0,  0, 45,  0,  0,  0,  0,  0, 55,  0,  4,  0,  0,  0,  0,  0,  0, 32,
+     0,  0,  0,  0,  0,  0,  0, 58,  0, 48, 41,  0,  0, 17,  0, 54,  0,  0,  3, 43,
+     0,  0, 12,  0,  0, 47,  0,  0,  0,  0, 14,  0,  7,  0, 53,  0,  0,  0,  0, 34,
+    10,  0,  0, 57,  0, 11,  0, 39,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0, 63,  0,  0,  0, 46,  0,  0,  0,  0,  0, 28,  0, 50,  0,  0, 40, 27,  0,
+     0, 19, 30,  0,  0,  0, 24,  1, 13, 16,  0,  0,  0,  0,  0, 20,  0
+};
+
+/** Hash of a word of \a n >= 2 bytes starting at \a w. */
+static inline unsigned keywordHash(const char *w, size_t n)
+{
+    const unsigned char *u = reinterpret_cast<const unsigned char*>(w);
+    return (36 * u[0] + 6 * u[n - 1] + 17 * u[1] + n) % KEYWORD_SLOTS;
+}
 
-    keywords["until"]      = KW_UNTIL;
+/** Find a keyword.
+ * \param first points to the first byte of a word.
+ * \param last points past the last byte of the word.
+ * \return the keyword whose text is the word, or 0 if the word is not a keyword.
+ */
+static const Keyword *findKeyword(const char *first, const char *last)
+{
+    size_t n = last - first;
+    if (n < 2 || n > 11)
+        return 0;
+    unsigned slot = keywordSlots[keywordHash(first, n)];
+    if (slot == 0)
+        return 0;
+    const Keyword *kw = &keywordList[slot - 1];
+    if (kw->length != n || memcmp(kw->text, first, n) != 0)
+        return 0;
+    return kw;
+}
 
-    keywords["while"]      = KW_WHILE;
+Scanner::Scanner()
+{
 }
 
 Scanner::~Scanner()
 {
-    //Out this was when we used a vector of char stars.
-//    for (vector<char*>::iterator it= source.begin(); it != source.end(); ++it)
-//        delete *it;
 }
 
-/** Read characters from an input stream, stopping at terminator
+/** The spellings of the operators and punctuation, interned once so
+ * that scanning them does not take the lock of the symbol pool.
+ */
+static const Symbol SYM_DOTS("..");
+static const Symbol SYM_PLUS_EQ("+=");
+static const Symbol SYM_PLUS("+");
+static const Symbol SYM_MINUS_EQ("-=");
+static const Symbol SYM_ARROW("->");
+static const Symbol SYM_MINUS("-");
+static const Symbol SYM_MUL_EQ("*=");
+static const Symbol SYM_MUL("*");
+static const Symbol SYM_CAT("//");
+static const Symbol SYM_DIV_EQ("/=");
+static const Symbol SYM_DIV("/");
+static const Symbol SYM_MOD_EQ("%=");
+static const Symbol SYM_PERC_PERC("%%");
+static const Symbol SYM_MOD("%");
+static const Symbol SYM_LE("<=");
+static const Symbol SYM_LT_GT("<>");
+static const Symbol SYM_MOVE("<-");
+static const Symbol SYM_LT("<");
+static const Symbol SYM_GE(">=");
+static const Symbol SYM_GT(">");
+static const Symbol SYM_ASSIGN(":=");
+static const Symbol SYM_COLON(":");
+static const Symbol SYM_TILDE_EQ("~=");
+static const Symbol SYM_BANG_EQ("!=");
+static const Symbol SYM_DOT(".");
+static const Symbol SYM_AND_EQ("&=");
+static const Symbol SYM_AT("@");
+static const Symbol SYM_EQ("=");
+static const Symbol SYM_SHARP("#");
+static const Symbol SYM_LB("[");
+static const Symbol SYM_RB("]");
+static const Symbol SYM_LC("{");
+static const Symbol SYM_RC("}");
+static const Symbol SYM_LP("(");
+static const Symbol SYM_RP(")");
+static const Symbol SYM_BAR("|");
+static const Symbol SYM_CARET("^");
+static const Symbol SYM_QUEST_MARK("?");
+static const Symbol SYM_COMMA(",");
+static const Symbol SYM_SEMICOLON(";");
+
+/** Read a character or text literal.
  *  Non-graphic characters are encoded with escapes.
- * \param pc points to the ' or " at the start of the string.
+ *  Other characters, including multibyte UTF-8 characters,
+ *  are copied unchanged.
+ * \param pc points to the ' or " at the start of the string,
+ *        and is left pointing past the terminating character.
+ * \param eol is the end of the current line.
  * \param term is the terminating character, ' or ".
- * \param line points to the beginning of the current line,
+ * \param pos is a token at the position of the literal,
  *        and is used for reporting illegal characters.
  */
-Glib::ustring readChars(Glib::ustring::iterator pc, char term, Glib::ustring line)
+static string readChars(const char * & pc, const char *eol, char term, const Token & pos)
 {
     string result;
     while (true)
     {
         ++pc;
-        if (*pc == term)
+        if (pc == eol)
         {
-            ++pc;
+            CompilationContext::current().diagnostics() << "Warning: line break in character or text literal." << pos;
             return result;
         }
-        else if (*pc == '\0')
+        else if (*pc == term)
         {
-            cerr << "Warning: line break in character or text literal.\n" << line;
+            ++pc;
             return result;
         }
         else if (*pc == '\\')
         {
             ++pc;
-            switch (*pc)
+            switch (at(pc, eol))
             {
                 case 'n':
                     result += '\n';
@@ -146,14 +298,16 @@ Glib::ustring readChars(Glib::ustring::iterator pc, char term, Glib::ustring lin
                 case '\'':
                     result += '\'';
                     break;
-                    case '\"':
-                        result += '\"';
+                case '\"':
+                    result += '\"';
                     break;
                 case '\\':
                     result += '\\';
                     break;
                 default:
-                    cerr << "Warning: illegal character following \\.\n" << line;
+                    CompilationContext::current().diagnostics() << "Warning: illegal character following \\." << pos;
+                    if (pc == eol)
+                        return result;
             }
         }
         else
@@ -161,383 +315,399 @@ Glib::ustring readChars(Glib::ustring::iterator pc, char term, Glib::ustring lin
     }
 }
 
-/** Scan a file and generate a list of tokens.
- * \param filename is the name of the file to read from.
- * \param tokens is a list to which tokens will be appended.
- * \throw If the file cannot be opened, report an error and throw an exception.
- */
-void Scanner::scanFile(string filename, list<Token> & tokens)
+void Scanner::open(const string & filename)
 {
-    ifstream ifs(filename.c_str());
-    if (!ifs)
-        Error() << "failed to open input file '" << filename << "'.\n" << THROW;
-
-    //const int BUFSIZE = 1000;
-    //char buffer[BUFSIZE];
-    //char *pc;
-    string buffer;
-    source.clear(); // Delete stuff from previous file
+    SourceManager & sources = CompilationContext::current().sources;
+    file = sources.addFile(filename);
+    text = sources.begin(file);
+    end = sources.end(file);
+    if (text == end)
+        Error() << "input file '" << filename << "' is empty.\n" << THROW;
+    pc = text;
+    findEol();
+    lines = &sources.lineMap(file);
+    lineNum = 1;
+    sourceLine = lines->empty() ? lineNum : (*lines)[0];
+    lookahead.clear();
+    la = 0;
+}
 
-    while (getline(ifs, buffer))
+bool Scanner::next(Token & tok)
+{
+    while (la == lookahead.size())
     {
-        // Big memory leak here?
-        //char* pc = new char[strlen(buffer) + 1];
-        //strcpy(pc, buffer);
-        source.push_back(Glib::locale_to_utf8(buffer));
+        lookahead.clear();
+        la = 0;
+        if (!scanToken(lookahead))
+            return false;
     }
-    ifs.close();
+    tok = lookahead[la++];
+    return true;
+}
 
-    vector<Glib::ustring>::iterator srcit = source.begin();
-    Glib::ustring::iterator pc, source_begin;
-    if (srcit == source.end())
-        Error() << "input file '" << filename << "' is empty.\n" << THROW;
+/** Set \a eol to the end of the line that starts at \a pc. */
+void Scanner::findEol()
+{
+    eol = static_cast<const char*>(memchr(pc, '\n', end - pc));
+    if (!eol)
+        eol = end;
+}
 
-    source_begin = pc = srcit->begin();
+/** Scan the next token and append it to \a tokens.
+ * Most tokens are scanned alone; an integer followed by '..'
+ * gives two tokens, and an illegal character gives none.
+ * \param tokens is a vector to which tokens will be appended.
+ * \return \a false at the end of the file.
+ */
+bool Scanner::scanToken(vector<Token> & tokens)
+{
+    // Skip white space, comments and line breaks.
     while (true)
     {
-        int state = 0;
-        do
-        {
-            switch (state)
-            {
-                case 0: // Initial state: no context
-                    if (*pc == '\0')
-                    {
-                        ++srcit;
-                        if (srcit == source.end())
-                            return;
-                        source_begin = pc = srcit->begin();
-                    }
-                    else if (*pc == '-')
-                    {
-                        state = 1;
-                        ++pc;
-                    }
-                    else if (!isspace(*pc))
-                        state = 3;
-                    else
-                        ++pc;
-                    break;
-
-                case 1: // Seen '-': might be a comment
-                    if (*pc == '-')
-                    {
-                        state = 2;
-                        ++pc;
-                    }
-                    else
-                    {
-                        state = 3;
-                        --pc;
-                    }
-                    break;
+        while (pc < eol && charClass[*pc] == CC_SPACE)
+            ++pc;
+        if (pc < eol && !(*pc == '-' && at(pc + 1, eol) == '-'))
+            break;
+        if (eol == end)
+            return false;
+        pc = eol + 1;
+        findEol();
+        ++lineNum;
+        sourceLine = lines->empty() ? lineNum : (*lines)[lineNum - 1];
+    }
 
-                case 2: // Seen '--': read comment
-                    ++srcit;
-                    if (srcit == source.end())
-                        return;
-                    source_begin = pc = srcit->begin();
-                    state = 0;
-                    break;
-            }
-        }
-        while (state < 3);
+    // *pc holds the first character of the next token.
+    start = pc - text;
 
-        // *pc holds the first character of the next token.
-        Errpos ep(*srcit, 
-                  distance(source.begin(), srcit) + 1,
-                  distance(source_begin,pc));
+    CharClass cc = charClass[*pc];
 
-        // Digit => numeric literal.
-        if (isdigit(*pc))
+    // Digit => numeric literal.
+    if (cc == CC_DIGIT)
+    {
+        const char *first = pc;
+        bool hasPoint = false;
+        //         bool byte = false;
+        bool floating = false;
+        bool dots = false;
+        while (charClass[at(pc, eol)] == CC_DIGIT)
+            ++pc;
+        if (at(pc, eol) == 'e' || at(pc, eol) == 'E')
+        {
+            hasPoint = true;
+            ++pc;
+            if (at(pc, eol) == '+' || at(pc, eol) == '-')
+                ++pc;
+            while (charClass[at(pc, eol)] == CC_DIGIT)
+                ++pc;
+        }
+        else if (at(pc, eol) == '.')
         {
-            Glib::ustring val;
-            bool hasPoint = false;
-            //         bool byte = false;
-            bool floating = false;
-            bool dots = false;
-            while (isdigit(*pc))
-                val += *pc++;
-            if (*pc == 'e' || *pc == 'E')
+            if (at(pc + 1, eol) == '.')
+                dots = true;
+            else
             {
                 hasPoint = true;
-                val += *pc++;
-                if (*pc == '+' || *pc == '-')
-                    val += *pc++;
-                while (isdigit(*pc))
-                    val += *pc++;
-            }
-            else if (*pc == '.')
-            {
-                pc++;
-                if (*pc == '.')
-                {
-                    dots = true;
-                    pc++;
-                }
-                else
+                ++pc;
+                while (charClass[at(pc, eol)] == CC_DIGIT)
+                    ++pc;
+                if (at(pc, eol) == 'e' || at(pc, eol) == 'E')
                 {
-                    pc--;
-                    hasPoint = true;
-                    val += *pc++;
-                    while (isdigit(*pc))
-                        val += *pc++;
-                    if (*pc == 'e' || *pc == 'E')
-                    {
-                        hasPoint = true;
-                        val += *pc++;
-                        if (*pc == '+' || *pc == '-')
-                            val += *pc++;
-                        while (isdigit(*pc))
-                            val += *pc++;
-                    }
+                    ++pc;
+                    if (at(pc, eol) == '+' || at(pc, eol) == '-')
+                        ++pc;
+                    while (charClass[at(pc, eol)] == CC_DIGIT)
+                        ++pc;
                 }
             }
-            if (floating || hasPoint)
-                tokens.push_back(Token(ep, DECIMALVAL, val));
-            else
-            {
-                tokens.push_back(Token(ep, INTVAL, val));
-                if (dots)
-                    tokens.push_back(Token(ep, OP_DOTS, ".."));
-            }
         }
-        else if (isalpha(*pc))
+        Symbol val(first, pc);
+        if (floating || hasPoint)
+            tokens.push_back(token(DECIMALVAL, val));
+        else
         {
-            string idval;
-            while (isalnum(*pc) || *pc == '_')
-                idval += *pc++;
-            if (keywords.find(idval) == keywords.end())
-                // Not a keyword - must be an identifier
-                tokens.push_back(Token(ep, IDENVAL, idval));
-            else
+            tokens.push_back(token(INTVAL, val));
+            if (dots)
             {
-                // It's a keyword.
-                tokens.push_back(Token(ep, keywords[idval], idval, true));
+                tokens.push_back(token(OP_DOTS, SYM_DOTS));
+                pc += 2;
             }
         }
-        else if (*pc == '"')
+    }
+    else if (cc == CC_LETTER || (cc == CC_HIGH && skipUnicode(pc, eol, false) != pc))
+    {
+        // ASCII letters, digits and '_' need no decoding.
+        const char *first = pc;
+        while (pc < eol)
         {
-            string value = readChars(pc, '"', *srcit);
-            if (value.length() == 1)
-                tokens.push_back(Token(ep, CHARVAL, value));
+            CharClass c = charClass[*pc];
+            if (c == CC_LETTER || c == CC_DIGIT || *pc == '_')
+                ++pc;
+            else if (c == CC_HIGH)
+            {
+                const char *next = skipUnicode(pc, eol, true);
+                if (next == pc)
+                    break;
+                pc = next;
+            }
             else
-                tokens.push_back(Token(ep, TEXTVAL, value));
+                break;
         }
-        else if (*pc == '\'')
+        const Keyword *kw = findKeyword(first, pc);
+        if (kw == 0)
+            // Not a keyword - must be an identifier
+            tokens.push_back(token(IDENVAL, Symbol(first, pc)));
+        else
         {
-            string value = readChars(pc, '\'', *srcit);
-            if (value.length() == 1)
-                tokens.push_back(Token(ep, CHARVAL, value));
-            else
-                tokens.push_back(Token(ep, TEXTVAL, value));
+            // It's a keyword.
+            tokens.push_back(token(kw->kind, Symbol(first, pc), true));
         }
+    }
+    else if (*pc == '"' || *pc == '\'')
+    {
+        string value = readChars(pc, eol, *pc, token(END_MARKER));
+        if (value.length() == 1)
+            tokens.push_back(token(CHARVAL, Symbol(value)));
         else
+            tokens.push_back(token(TEXTVAL, Symbol(value)));
+    }
+    else
+    {
+        switch (*pc)
         {
-            switch (*pc)
-            {
-
-                // Digraphs
-
-                case '+':
-                    ++pc;
-                    if (*pc == '=')
-                        tokens.push_back(Token(ep, OP_PLUS_EQ, "+="));
-                    else
-                    {
-                        tokens.push_back(Token(ep, OP_PLUS, "+"));
-                        --pc;
-                    }
-                    break;
-
-                case '-':
-                    ++pc;
-                    if (*pc == '=')
-                        tokens.push_back(Token(ep, OP_MINUS_EQ, "-="));
-                    else if (*pc == '>')
-                        tokens.push_back(Token(ep, ARROW, "->"));  // not used any more
-                    else
-                    {
-                        tokens.push_back(Token(ep, OP_MINUS, "-"));
-                        --pc;
-                    }
-                    break;
-
-                case '*':
-                    ++pc;
-                    if (*pc == '=')
-                        tokens.push_back(Token(ep, OP_MUL_EQ, "*="));
-                    else
-                    {
-                        tokens.push_back(Token(ep, OP_MUL, "*"));
-                        --pc;
-                    }
-                    break;
 
-                case '/':
-                    ++pc;
-                    if (*pc == '/')
-                        tokens.push_back(Token(ep, OP_CAT, "//"));
-                    else if (*pc == '=')
-                        tokens.push_back(Token(ep, OP_DIV_EQ, "/="));
-                    else
-                    {
-                        tokens.push_back(Token(ep, OP_DIV, "/"));
-                        --pc;
-                    }
-                    break;
+            // Digraphs
 
-                case '%':
-                    ++pc;
-                    if (*pc == '=')
-                        tokens.push_back(Token(ep, OP_MOD_EQ, "%="));
-                    else if (*pc == '%')
-                        tokens.push_back(Token(ep, PERC_PERC, "%%"));
-                    else
-                    {
-                        tokens.push_back(Token(ep, OP_MOD, "%"));
-                        --pc;
-                    }
-                    break;
+            case '+':
+                ++pc;
+                if (at(pc, eol) == '=')
+                    tokens.push_back(token(OP_PLUS_EQ, SYM_PLUS_EQ));
+                else
+                {
+                    tokens.push_back(token(OP_PLUS, SYM_PLUS));
+                    --pc;
+                }
+                break;
+
+            case '-':
+                ++pc;
+                if (at(pc, eol) == '=')
+                    tokens.push_back(token(OP_MINUS_EQ, SYM_MINUS_EQ));
+                else if (at(pc, eol) == '>')
+                    tokens.push_back(token(ARROW, SYM_ARROW));  // not used any more
+                else
+                {
+                    tokens.push_back(token(OP_MINUS, SYM_MINUS));
+                    --pc;
+                }
+                break;
 
-                case '<':
-                    ++pc;
-                    if (*pc == '=')
-                        tokens.push_back(Token(ep, OP_LE, "<="));
-                    else if (*pc == '>')
-                        tokens.push_back(Token(ep, OP_NE, "<>"));
-                    else if (*pc == '-')
-                        tokens.push_back(Token(ep, OP_MOVE, "<-"));
-                    else
-                    {
-                        tokens.push_back(Token(ep, OP_LT, "<"));
-                        --pc;
-                    }
-                    break;
+            case '*':
+                ++pc;
+                if (at(pc, eol) == '=')
+                    tokens.push_back(token(OP_MUL_EQ, SYM_MUL_EQ));
+                else
+                {
+                    tokens.push_back(token(OP_MUL, SYM_MUL));
+                    --pc;
+                }
+                break;
+
+            case '/':
+                ++pc;
+                if (at(pc, eol) == '/')
+                    tokens.push_back(token(OP_CAT, SYM_CAT));
+                else if (at(pc, eol) == '=')
+                    tokens.push_back(token(OP_DIV_EQ, SYM_DIV_EQ));
+                else
+                {
+                    tokens.push_back(token(OP_DIV, SYM_DIV));
+                    --pc;
+                }
+                break;
+
+            case '%':
+                ++pc;
+                if (at(pc, eol) == '=')
+                    tokens.push_back(token(OP_MOD_EQ, SYM_MOD_EQ));
+                else if (at(pc, eol) == '%')
+                    tokens.push_back(token(PERC_PERC, SYM_PERC_PERC));
+                else
+                {
+                    tokens.push_back(token(OP_MOD, SYM_MOD));
+                    --pc;
+                }
+                break;
+
+            case '<':
+                ++pc;
+                if (at(pc, eol) == '=')
+                    tokens.push_back(token(OP_LE, SYM_LE));
+                else if (at(pc, eol) == '>')
+                    tokens.push_back(token(OP_NE, SYM_LT_GT));
+                else if (at(pc, eol) == '-')
+                    tokens.push_back(token(OP_MOVE, SYM_MOVE));
+                else
+                {
+                    tokens.push_back(token(OP_LT, SYM_LT));
+                    --pc;
+                }
+                break;
 
-                case '>':
-                    ++pc;
-                    if (*pc == '=')
-                        tokens.push_back(Token(ep, OP_GE, ">="));
-                    else
-                    {
-                        tokens.push_back(Token(ep, OP_GT, ">"));
-                        --pc;
-                    }
-                    break;
+            case '>':
+                ++pc;
+                if (at(pc, eol) == '=')
+                    tokens.push_back(token(OP_GE, SYM_GE));
+                else
+                {
+                    tokens.push_back(token(OP_GT, SYM_GT));
+                    --pc;
+                }
+                break;
 
-                case ':':
-                    ++pc;
-                    if (*pc == '=')
-                        tokens.push_back(Token(ep, OP_ASSIGN, ":="));
-                    else
-                    {
-                        tokens.push_back(Token(ep, COLON, ":"));
-                        --pc;
-                    }
-                    break;
+            case ':':
+                ++pc;
+                if (at(pc, eol) == '=')
+                    tokens.push_back(token(OP_ASSIGN, SYM_ASSIGN));
+                else
+                {
+                    tokens.push_back(token(COLON, SYM_COLON));
+                    --pc;
+                }
+                break;
 
-                case '~':
-                    ++pc;
-                    if (*pc == '=')
-                        tokens.push_back(Token(ep, OP_NE, "~="));
-                    else
-                        cerr << "Warning: '~' not followed by '='." << ep;
-                    break;
+            case '~':
+                ++pc;
+                if (at(pc, eol) == '=')
+                    tokens.push_back(token(OP_NE, SYM_TILDE_EQ));
+                else
+                {
+                    CompilationContext::current().diagnostics() << "Warning: '~' not followed by '='." << token(END_MARKER);
+                    --pc;
+                }
+                break;
 
-                case '!':
-                    ++pc;
-                    if (*pc == '=')
-                        tokens.push_back(Token(ep, OP_NE, "!="));
-                    else
-                        cerr << "Warning: '!' not followed by '='." << ep;
-                    break;
+            case '!':
+                ++pc;
+                if (at(pc, eol) == '=')
+                    tokens.push_back(token(OP_NE, SYM_BANG_EQ));
+                else
+                {
+                    CompilationContext::current().diagnostics() << "Warning: '!' not followed by '='." << token(END_MARKER);
+                    --pc;
+                }
+                break;
 
-                case '.': // 071108
-                    ++pc;
-                    if (*pc == '.')
-                        tokens.push_back(Token(ep, OP_DOTS, ".."));
-                    else
-                    {
-                        tokens.push_back(Token(ep, DOT, "."));
-                        --pc;
-                    }
-                    break;
+            case '.': // 071108
+                ++pc;
+                if (at(pc, eol) == '.')
+                    tokens.push_back(token(OP_DOTS, SYM_DOTS));
+                else
+                {
+                    tokens.push_back(token(DOT, SYM_DOT));
+                    --pc;
+                }
+                break;
 
-                case '&': // 081125
-                    ++pc;
-                    if (*pc == '=')
-                        tokens.push_back(Token(ep, OP_AND_EQ, "&="));
-                    else
-                        cerr << "Warning: '&' not followed by '='." << ep;
-                    break;
+            case '&': // 081125
+                ++pc;
+                if (at(pc, eol) == '=')
+                    tokens.push_back(token(OP_AND_EQ, SYM_AND_EQ));
+                else
+                {
+                    CompilationContext::current().diagnostics() << "Warning: '&' not followed by '='." << token(END_MARKER);
+                    --pc;
+                }
+                break;
 
-                    // Single characters
+                // Single characters
 
-                case '@':
-                    tokens.push_back(Token(ep, AT, "@"));
-                    break;
+            case '@':
+                tokens.push_back(token(AT, SYM_AT));
+                break;
 
-                case '=':
-                    tokens.push_back(Token(ep, OP_EQ, "="));
-                    break;
+            case '=':
+                tokens.push_back(token(OP_EQ, SYM_EQ));
+                break;
 
-                case '#': // 071108
-                    tokens.push_back(Token(ep, OP_SHARP, "#"));
-                    break;
+            case '#': // 071108
+                tokens.push_back(token(OP_SHARP, SYM_SHARP));
+                break;
 
-                case '[':
-                    tokens.push_back(Token(ep, LB, "["));
-                    break;
+            case '[':
+                tokens.push_back(token(LB, SYM_LB));
+                break;
 
-                case ']':
-                    tokens.push_back(Token(ep, RB, "]"));
-                    break;
+            case ']':
+                tokens.push_back(token(RB, SYM_RB));
+                break;
 
-                case '{':
-                    tokens.push_back(Token(ep, LC, "{"));
-                    break;
+            case '{':
+                tokens.push_back(token(LC, SYM_LC));
+                break;
 
-                case '}':
-                    tokens.push_back(Token(ep, RC, "}"));
-                    break;
+            case '}':
+                tokens.push_back(token(RC, SYM_RC));
+                break;
 
-                case '(':
-                    tokens.push_back(Token(ep, LP, "("));
-                    break;
+            case '(':
+                tokens.push_back(token(LP, SYM_LP));
+                break;
 
-                case ')':
-                    tokens.push_back(Token(ep, RP, ")"));
-                    break;
+            case ')':
+                tokens.push_back(token(RP, SYM_RP));
+                break;
 
-                case '|':
-                    tokens.push_back(Token(ep, BAR, "|"));
-                    break;
+            case '|':
+                tokens.push_back(token(BAR, SYM_BAR));
+                break;
 
-                case '^':
-                    tokens.push_back(Token(ep, CARET, "^"));
-                    break;
+            case '^':
+                tokens.push_back(token(CARET, SYM_CARET));
+                break;
 
-                case '?':
-                    tokens.push_back(Token(ep, QUEST_MARK, "?"));
-                    break;
+            case '?':
+                tokens.push_back(token(QUEST_MARK, SYM_QUEST_MARK));
+                break;
 
-                case ',':
-                    tokens.push_back(Token(ep, COMMA, ","));
-                    break;
+            case ',':
+                tokens.push_back(token(COMMA, SYM_COMMA));
+                break;
 
-                case ';':
-                    tokens.push_back(Token(ep, SEMICOLON, ";"));
-                    break;
+            case ';':
+                tokens.push_back(token(SEMICOLON, SYM_SEMICOLON));
+                break;
 
-                default:
-                    cerr << "Warning: illegal character." << ep;
+            default:
+                CompilationContext::current().diagnostics() << "Warning: illegal character." << token(END_MARKER);
 
-            }
-            ++pc;
+                // Skip the whole of a multibyte character.
+                if (cc == CC_HIGH)
+                    while (pc + 1 < eol && (pc[1] & 0xC0) == 0x80)
+                        ++pc;
         }
+        ++pc;
     }
+    return true;
 }
 
+TokenStream::TokenStream(const vector<Glib::ustring> & filenames)
+    : filenames(filenames), nextFile(0)
+{
+    ++*this;
+}
 
-
+TokenStream & TokenStream::operator++()
+{
+    if (current.kind == END_OF_FILE)
+        return *this;
+    while (nextFile == 0 || !sc.next(current))
+    {
+        if (nextFile == filenames.size())
+        {
+            current = Token(END_OF_FILE, "EOF");
+            break;
+        }
+        sc.open(filenames[nextFile++]);
+    }
+    return *this;
+}
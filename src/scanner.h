@@ -7,8 +7,6 @@
 
 #include "token.h"
 
-#include <list>
-#include <map>
 #include <string>
 #include <vector>
 #include <glibmm.h>
@@ -17,8 +15,7 @@ using namespace std;
 
 /** An instance is an object that can perform
  * lexical analysis of a given input file.
- * The scanner should not be deleted until compilation is complete,
- * because it stores the source text.
+ * The source text is kept by the source manager of the compilation.
  */
 class Scanner
 {
@@ -30,24 +27,117 @@ class Scanner
         /** Delete scanner and source text. */
         ~Scanner();
 
-        /** Scan a file.
+        /** Start scanning a file.
          * \param filename is the full name/path of the input file.
-         * \param tokens is a list of tokens to which the scanner
-         will append all tokens read from the file.
-         * \throw an instance of class OldStyleError giving the position
-         *        of the error in the source file and a diagnostic.
+         * \throw if the file cannot be opened or is empty.
          */
-        void scanFile(string filename, list<Token> & tokens);
+        void open(const string & filename);
+
+        /** Scan the next token of the file.
+         * \param tok receives the token.
+         * \return \a false, leaving \a tok unchanged, at the end of the file.
+         */
+        bool next(Token & tok);
+
+    private:
+
+        /** Scan the next token. */
+        bool scanToken(vector<Token> & tokens);
+
+        /** Find the end of the current line. */
+        void findEol();
+
+        /** Make a token that starts at the current position. */
+        Token token(TokenKind kind, Symbol value = Symbol(), bool keyword = false) const
+        {
+            return Token(kind, value, keyword, file, start, sourceLine);
+        }
+
+        /** Number of the file being scanned. */
+        int file;
+
+        /** Text of the file being scanned. */
+        const char *text;
+
+        /** End of the text of the file. */
+        const char *end;
+
+        /** Next character to be scanned. */
+        const char *pc;
+
+        /** End of the current line. */
+        const char *eol;
+
+        /** Tokens that have been scanned but not yet delivered:
+         *  never more than two.
+         */
+        vector<Token> lookahead;
+
+        /** Index of the next token to deliver from \a lookahead. */
+        size_t la;
+
+        /** Offset of the first byte of the current token. */
+        unsigned start;
+
+        /** Number of the current line. */
+        int lineNum;
+
+        /** Number of the current line in the original file, which
+         *  differs from \a lineNum if the text was extracted.
+         */
+        int sourceLine;
+
+        /** Original line numbers of extracted text, or empty. */
+        const vector<int> *lines;
+};
+
+/** An instance delivers the tokens of a sequence of source files to
+ * the parser, scanning each token when it is needed: no token list
+ * is built.  The current token is accessed with -> or *, and ++
+ * moves to the next one.  After the last file, the current token
+ * is END_OF_FILE.
+ */
+class TokenStream
+{
+    public:
+
+        /** Construct a stream for the files \a filenames, in order,
+         *  and scan the first token.
+         */
+        TokenStream(const vector<Glib::ustring> & filenames);
+
+        /** \return the current token. */
+        const Token & operator*() const
+        {
+            return current;
+        }
+
+        /** \return the current token. */
+        const Token *operator->() const
+        {
+            return &current;
+        }
+
+        /** Move to the next token. */
+        TokenStream & operator++();
 
     private:
 
-        /** A map giving the kind of token corresponding to each keyword string. */
-        map<Glib::ustring, TokenKind> keywords;
+        /** The scanner for the current file. */
+        Scanner sc;
+
+        /** The files to scan. */
+        vector<Glib::ustring> filenames;
+
+        /** Index of the next file to open. */
+        size_t nextFile;
 
-        /** The source text of the file.
-          Each element points to a line of source code.*/
-        vector<Glib::ustring> source;
+        /** The current token. */
+        Token current;
 
+        // Not copyable.
+        TokenStream(const TokenStream &);
+        void operator=(const TokenStream &);
 };
 
 #endif
@@ -0,0 +1,107 @@
+/** \file scope.cpp
+ * Implementation of classes Scope and NameTable.
+ */
+
+#include "scope.h"
+#include "ast.h"
+
+using namespace std;
+
+Scope::Scope(Node p)
+    : outer(CompilationContext::current().scope), parent(0), base(p), head(p)
+{
+    if (outer && outer->head == p)
+        parent = outer;
+    CompilationContext::current().scope = this;
+}
+
+Scope::~Scope()
+{
+    CompilationContext::current().scope = outer;
+}
+
+void Scope::add(Node node)
+{
+    // A node that is not linked to the head, or whose lookUp() cannot
+    // be described by a table, starts a stretch that must be walked.
+    if (node->getDefChain() != head || !node->define(*this))
+    {
+        names.clear();
+        parent = 0;
+        base = node;
+    }
+    head = node;
+}
+
+void Scope::insert(Symbol name, Node definition)
+{
+    names[name.id()] = definition;
+}
+
+Node Scope::resolve(Node p, Symbol name, Errpos ep)
+{
+    Scope *scope = CompilationContext::current().scope;
+    if (!scope || scope->head != p)
+        return walk(p, name, ep);
+    while (true)
+    {
+        tr1::unordered_map<unsigned, Node>::const_iterator it = scope->names.find(name.id());
+        if (it != scope->names.end())
+            return it->second;
+        if (!scope->parent)
+            return walk(scope->base, name, ep);
+        scope = scope->parent;
+    }
+}
+
+Node Scope::walk(Node p, Symbol name, Errpos ep)
+{
+    for ( ; p; p = p->getDefChain())
+    {
+        Node q = p->lookUp(name, ep);
+        if (q)
+            return q;
+    }
+    return 0;
+}
+
+NameTable::NameTable() : current(1), counter(1)
+{}
+
+void NameTable::enter()
+{
+    frames.push_back(Frame(log.size(), current));
+    current = ++counter;
+}
+
+void NameTable::mark()
+{
+    frames.push_back(Frame(log.size(), current));
+}
+
+void NameTable::leave()
+{
+    Frame frame = frames.back();
+    frames.pop_back();
+    while (log.size() > frame.logSize)
+    {
+        owners[log.back().first] = log.back().second;
+        log.pop_back();
+    }
+    current = frame.scope;
+}
+
+bool NameTable::contains(Symbol name) const
+{
+    tr1::unordered_map<unsigned, unsigned>::const_iterator it = owners.find(name.id());
+    return it != owners.end() && it->second == current;
+}
+
+void NameTable::insert(Symbol name)
+{
+    unsigned & owner = owners[name.id()];
+    if (owner == current)
+        return;
+    log.push_back(make_pair(name.id(), owner));
+    owner = current;
+}
@@ -0,0 +1,150 @@
+/** \file scope.h
+ * Declarations of classes Scope and NameTable.
+ */
+
+#ifndef SCOPE_H
+#define SCOPE_H
+
+#include "symbol.h"
+#include "types.h"
+
+#include <tr1/unordered_map>
+#include <utility>
+#include <vector>
+
+struct Errpos;
+
+/** An instance indexes the names defined by a stretch of the
+ * definition chain, so that binding a name takes a hash lookup per
+ * enclosing scope instead of a walk along the chain.
+ *
+ * Scopes are opened on the stack by the bind() functions that extend
+ * the chain, and each node added to the chain is added to the scope.
+ * The scope most recently opened is the current one.  A scope knows
+ * the chain node that it describes (its head); lookups from any
+ * other node, and lookups that reach a stretch of chain that a
+ * scope cannot describe, walk the chain as before.  The result of
+ * a lookup is therefore always the definition nearest on the chain.
+ */
+class Scope
+{
+    public:
+
+        /** Open a scope that continues the definition chain from \a p,
+         * and make it the current scope.
+         */
+        Scope(Node p);
+
+        /** Make the enclosing scope current again. */
+        ~Scope();
+
+        /** Add \a node, which has been bound and now heads the chain.
+         * Its definitions hide earlier definitions of the same names.
+         */
+        void add(Node node);
+
+        /** Record that \a name is defined by \a definition.
+         *  This is used by BaseNode::define().
+         */
+        void insert(Symbol name, Node definition);
+
+        /** Find the definition of \a name on the chain that starts at \a p.
+         * \return the definition, or 0 if \a name is not defined.
+         */
+        static Node resolve(Node p, Symbol name, Errpos ep);
+
+    private:
+
+        // Not copyable: the scope is referred to by the context.
+        Scope(const Scope &);
+        void operator=(const Scope &);
+
+        /** \return the definition of \a name found by walking the chain from \a p. */
+        static Node walk(Node p, Symbol name, Errpos ep);
+
+        /** The scope that was current when this one was opened. */
+        Scope *outer;
+
+        /** The scope that describes the chain below this one, or 0 if
+         * the chain below must be walked from \a base.
+         */
+        Scope *parent;
+
+        /** The chain node below the nodes in this scope. */
+        Node base;
+
+        /** The chain node that the scope describes. */
+        Node head;
+
+        /** The definitions in this scope, by symbol number. */
+        std::tr1::unordered_map<unsigned, Node> names;
+};
+
+/** An instance holds the names declared in the current scope of the
+ * checking pass, so that a name declared twice in one scope can be
+ * reported.  Scopes nest: a name of an enclosing scope may be
+ * declared again in an inner one.
+ *
+ * Each name records the scope that declared it most recently, and
+ * an undo log records what it replaced.  Entering a scope costs
+ * nothing, and leaving it costs one step per name declared in it.
+ */
+class NameTable
+{
+    public:
+
+        /** Construct a table with one, empty, scope. */
+        NameTable();
+
+        /** Enter a new scope, in which no names are declared. */
+        void enter();
+
+        /** Enter a block of the current scope: names declared in it
+         * belong to the current scope until the block is left.
+         */
+        void mark();
+
+        /** Leave the scope or block that was entered last, forgetting
+         * the names declared in it.
+         */
+        void leave();
+
+        /** \return true if \a name has been declared in the current scope. */
+        bool contains(Symbol name) const;
+
+        /** Declare \a name in the current scope. */
+        void insert(Symbol name);
+
+    private:
+
+        /** A scope or block that has been entered. */
+        struct Frame
+        {
+            Frame(size_t logSize, unsigned scope) : logSize(logSize), scope(scope) {}
+
+            /** The length of the undo log when it was entered. */
+            size_t logSize;
+
+            /** The scope that was current when it was entered. */
+            unsigned scope;
+        };
+
+        /** For each name, the number of the scope that declared it
+         * last, or 0.
+         */
+        std::tr1::unordered_map<unsigned, unsigned> owners;
+
+        /** Names declared, with the owners that they replaced. */
+        std::vector< std::pair<unsigned, unsigned> > log;
+
+        /** The scopes and blocks that have been entered. */
+        std::vector<Frame> frames;
+
+        /** The number of the current scope. */
+        unsigned current;
+
+        /** The number of scopes entered so far. */
+        unsigned counter;
+};
+
+#endif
@@ -0,0 +1,335 @@
+/** \file server.cpp
+ * Implementation of the compile server (+S) and its client (+X).
+ *
+ * A request or reply is a sequence of strings, each written as its
+ * length in decimal, a newline, and its bytes.  A request is the
+ * client's directory, the number of arguments, and the arguments.
+ * A reply is the exit status, the number of outputs, the outputs,
+ * and the diagnostics.
+ */
+
+#include "error.h"
+#include "server.h"
+
+#include <cerrno>
+#include <climits>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+/** Write \a n bytes from \a p to \a fd. \return \a false if the write fails. */
+static bool writeAll(int fd, const char *p, size_t n)
+{
+    while (n > 0)
+    {
+        ssize_t w = write(fd, p, n);
+        if (w < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        p += w;
+        n -= w;
+    }
+    return true;
+}
+
+/** Read \a n bytes from \a fd into \a p. \return \a false at end of input or on failure. */
+static bool readAll(int fd, char *p, size_t n)
+{
+    while (n > 0)
+    {
+        ssize_t r = read(fd, p, n);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r <= 0)
+            return false;
+        p += r;
+        n -= r;
+    }
+    return true;
+}
+
+/** Write \a s to \a fd. */
+static bool sendString(int fd, const string & s)
+{
+    ostringstream header;
+    header << s.size() << '\n';
+    return writeAll(fd, header.str().data(), header.str().size()) &&
+           writeAll(fd, s.data(), s.size());
+}
+
+/** Write \a n to \a fd. */
+static bool sendInt(int fd, int n)
+{
+    ostringstream os;
+    os << n;
+    return sendString(fd, os.str());
+}
+
+/** The longest string that is accepted: longer ones are malformed. */
+const size_t MAX_STRING = 64 * 1024 * 1024;
+
+/** The longest list of strings that is accepted. */
+const int MAX_STRINGS = 64 * 1024;
+
+/** Read a string written by sendString() from \a fd into \a s.
+ * \return \a false at end of input or if the input is malformed.
+ */
+static bool receiveString(int fd, string & s)
+{
+    size_t size = 0;
+    char c;
+    while (true)
+    {
+        if (!readAll(fd, &c, 1))
+            return false;
+        if (c == '\n')
+            break;
+        if (c < '0' || c > '9')
+            return false;
+        size = 10 * size + c - '0';
+        if (size > MAX_STRING)
+            return false;
+    }
+    try
+    {
+        s.resize(size);
+    }
+    catch (const exception &)
+    {
+        return false;
+    }
+    return size == 0 || readAll(fd, &s[0], size);
+}
+
+/** Read an integer written by sendInt() from \a fd into \a n. */
+static bool receiveInt(int fd, int & n)
+{
+    string s;
+    if (!receiveString(fd, s) || s.empty())
+        return false;
+    char *end;
+    errno = 0;
+    long value = strtol(s.c_str(), &end, 10);
+    if (*end != '\0' || errno == ERANGE || value < INT_MIN || value > INT_MAX)
+        return false;
+    n = value;
+    return true;
+}
+
+/** Read a list of strings, preceded by its length, from \a fd into \a v. */
+static bool receiveStrings(int fd, vector<string> & v)
+{
+    int n;
+    if (!receiveInt(fd, n) || n < 0 || n > MAX_STRINGS)
+        return false;
+    v.resize(n);
+    for (int i = 0; i < n; ++i)
+        if (!receiveString(fd, v[i]))
+            return false;
+    return true;
+}
+
+/** Write a list of strings, preceded by its length, to \a fd. */
+static bool sendStrings(int fd, const vector<string> & v)
+{
+    if (!sendInt(fd, v.size()))
+        return false;
+    for (vector<string>::const_iterator it = v.begin(); it != v.end(); ++it)
+        if (!sendString(fd, *it))
+            return false;
+    return true;
+}
+
+/** Fill \a addr with the address of the socket \a path. */
+static void socketAddress(const string & path, sockaddr_un & addr)
+{
+    if (path.empty() || path.size() >= sizeof(addr.sun_path))
+        Error() << "Bad socket name '" << path << "'.\n" << THROW;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path.c_str());
+}
+
+/** Handle one request in a child process of the server.
+ *  Both standard streams go to a temporary file for the
+ *  duration, so that the reply carries everything the compiler
+ *  and the run-time library wrote.
+ */
+static void handleRequest(int conn, CompileHandler handler)
+{
+    CompileRequest request;
+    if (!receiveString(conn, request.directory) || !receiveStrings(conn, request.args))
+        return;
+
+    CompileReply reply;
+    FILE *capture = tmpfile();
+    if (chdir(request.directory.c_str()) != 0)
+    {
+        reply.status = 1;
+        reply.diagnostics = "Cannot change to directory '" + request.directory + "'.\n";
+    }
+    else if (!capture)
+    {
+        reply.status = 1;
+        reply.diagnostics = "Cannot capture diagnostics.\n";
+    }
+    else
+    {
+        cout.flush();
+        cerr.flush();
+        dup2(fileno(capture), STDOUT_FILENO);
+        dup2(fileno(capture), STDERR_FILENO);
+        try
+        {
+            reply.status = handler(request.args, reply.outputs);
+        }
+        catch (const Glib::ustring & msg)
+        {
+            cerr << msg;
+            reply.status = 1;
+        }
+        cout.flush();
+        cerr.flush();
+        fflush(stdout);
+        fflush(stderr);
+
+        rewind(capture);
+        char buffer[4096];
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), capture)) > 0)
+            reply.diagnostics.append(buffer, n);
+    }
+
+    sendInt(conn, reply.status);
+    sendStrings(conn, reply.outputs);
+    sendString(conn, reply.diagnostics);
+}
+
+/** \return \a true if the client connected to \a conn runs as the
+ * server's user.  Where the system cannot tell, the mode of the
+ * socket is relied on.
+ */
+static bool fromOwner(int conn)
+{
+#ifdef SO_PEERCRED
+    struct ucred cred;
+    socklen_t len = sizeof(cred);
+    if (getsockopt(conn, SOL_SOCKET, SO_PEERCRED, &cred, &len) < 0)
+        return false;
+    return cred.uid == getuid();
+#else
+    return true;
+#endif
+}
+
+/** Reap the children that have finished handling requests. */
+static void reapChildren(int)
+{
+    int saved = errno;
+    while (waitpid(-1, 0, WNOHANG) > 0)
+        ;
+    errno = saved;
+}
+
+void serve(const string & path, CompileHandler handler)
+{
+    sockaddr_un addr;
+    socketAddress(path, addr);
+
+    // Replace the socket of a server that has stopped, but nothing else.
+    struct stat st;
+    if (lstat(path.c_str(), &st) == 0)
+    {
+        if (!S_ISSOCK(st.st_mode))
+            Error() << "'" << path << "' exists and is not a socket.\n" << THROW;
+        unlink(path.c_str());
+    }
+
+    // A request can run code as the server's user, so only that user
+    // may connect: the socket is created with mode 0600.
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    mode_t mask = umask(077);
+    bool bound = listener >= 0 &&
+                 bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    int bindError = errno;
+    umask(mask);
+    errno = bindError;
+    if (!bound ||
+        chmod(path.c_str(), S_IRUSR | S_IWUSR) < 0 ||
+        listen(listener, SOMAXCONN) < 0)
+        Error() << "Cannot listen on '" << path << "': " << strerror(errno) << ".\n" << THROW;
+
+    // Reap the children as they finish.  They must not inherit an
+    // ignored SIGCHLD, which would stop them waiting for their own
+    // subprocesses, such as the assembler.
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = reapChildren;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+    sigaction(SIGCHLD, &action, 0);
+    cerr << "Serving requests on '" << path << "'.\n";
+
+    while (true)
+    {
+        int conn = accept(listener, 0, 0);
+        if (conn < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            Error() << "Cannot accept requests on '" << path << "': " << strerror(errno) << ".\n" << THROW;
+        }
+        if (!fromOwner(conn))
+        {
+            cerr << "Warning: refused a request from another user.\n";
+            close(conn);
+            continue;
+        }
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            close(listener);
+            signal(SIGCHLD, SIG_DFL);
+            handleRequest(conn, handler);
+            close(conn);
+            _exit(0);
+        }
+        if (pid < 0)
+            cerr << "Warning: cannot start a process for a request: " << strerror(errno) << ".\n";
+        close(conn);
+    }
+}
+
+void requestCompile(const string & path, const CompileRequest & request, CompileReply & reply)
+{
+    sockaddr_un addr;
+    socketAddress(path, addr);
+
+    int conn = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (conn < 0 || connect(conn, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0)
+        Error() << "Cannot reach the compile server on '" << path << "': " << strerror(errno) << ".\n" << THROW;
+
+    bool ok = sendString(conn, request.directory) && sendStrings(conn, request.args);
+    shutdown(conn, SHUT_WR);
+    ok = ok && receiveInt(conn, reply.status) &&
+         receiveStrings(conn, reply.outputs) &&
+         receiveString(conn, reply.diagnostics);
+    close(conn);
+    if (!ok)
+        Error() << "The compile server on '" << path << "' did not reply.\n" << THROW;
+}
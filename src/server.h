@@ -0,0 +1,60 @@
+/** \file server.h
+ * Declarations for the compile server (+S) and its client (+X).
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/** A request to compile, sent by a client to the server. */
+struct CompileRequest
+{
+    /** The client's working directory, in which file names are resolved. */
+    string directory;
+
+    /** The client's command-line arguments: options and file names. */
+    vector<string> args;
+};
+
+/** The server's reply to a CompileRequest. */
+struct CompileReply
+{
+    CompileReply() : status(0) {}
+
+    /** The exit status of the compilation. */
+    int status;
+
+    /** The files written by the compilation. */
+    vector<string> outputs;
+
+    /** Everything the compilation wrote to standard output and standard error. */
+    string diagnostics;
+};
+
+/** A function that compiles for the server.
+ * \param args are the client's command-line arguments.
+ * \param outputs receives the names of the files written.
+ * \return the exit status.
+ */
+typedef int (*CompileHandler)(const vector<string> & args, vector<string> & outputs);
+
+/** Accept requests on the Unix socket \a path until the server is killed.
+ * Each request is handled by \a handler in a process forked from the
+ * server, so that it starts from the server's initialised state, and
+ * requests from several clients run at the same time.  Only the
+ * server's user may connect: the socket has mode 0600, and requests
+ * from other users are refused.
+ * \throw if the socket cannot be created.
+ */
+void serve(const string & path, CompileHandler handler);
+
+/** Send \a request to the server listening on \a path and wait for the reply.
+ * \throw if the server cannot be reached.
+ */
+void requestCompile(const string & path, const CompileRequest & request, CompileReply & reply);
+
+#endif
@@ -32,6 +32,14 @@ void NameNode::setDefining(bool def)
     definingOccurrence = def;
 }
 
+//--------------------------------------------------------- rename
+
+/** Change the identifier of a name node. */
+void NameNode::rename(Symbol name)
+{
+    value = name;
+}
+
 //--------------------------------------------------------- setStartAddress
 
 /** Set start address for closure node. */
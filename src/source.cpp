@@ -0,0 +1,179 @@
+/** \file source.cpp
+ * Implementation of class SourceManager.
+ */
+
+#include "error.h"
+#include "source.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <glibmm.h>
+
+using namespace std;
+
+/** Serializes the addition of files to source managers: files may
+ * be added by the threads that scan source files in parallel.
+ */
+static Glib::StaticMutex filesMutex = GLIBMM_STATIC_MUTEX_INIT;
+
+string canonicalPath(const string & filename)
+{
+    char *path = realpath(filename.c_str(), 0);
+    if (!path)
+        return filename;
+    string result(path);
+    free(path);
+    return result;
+}
+
+SourceManager::SourceManager() : table(0)
+{}
+
+SourceManager::~SourceManager()
+{
+    clear();
+}
+
+int SourceManager::addFile(const string & filename)
+{
+    string path = canonicalPath(filename);
+    Glib::StaticMutex::Lock lock(filesMutex);
+    map<string, int>::const_iterator it = numbers.find(path);
+    if (it != numbers.end())
+        return it->second;
+
+    GError *error = 0;
+    GMappedFile *mapping = g_mapped_file_new(filename.c_str(), FALSE, &error);
+    if (!mapping)
+    {
+        Glib::ustring msg = error->message;
+        g_error_free(error);
+        Error() << "failed to open input file '" << filename << "': " << msg << ".\n" << THROW;
+    }
+
+    File *f = new File;
+    f->name = filename;
+    f->mapping = mapping;
+    f->text = g_mapped_file_get_contents(mapping);
+    f->size = g_mapped_file_get_length(mapping);
+
+    // Source files are in UTF-8 unless the locale says otherwise.
+    if (!Glib::get_charset() && f->size > 0)
+    {
+        f->converted = Glib::locale_to_utf8(string(f->text, f->size));
+        g_mapped_file_unref(mapping);
+        f->mapping = 0;
+        f->text = f->converted.data();
+        f->size = f->converted.size();
+    }
+
+    return numbers[path] = append(f);
+}
+
+int SourceManager::addText(const string & filename, const string & text, const vector<int> & lines)
+{
+    string path = canonicalPath(filename);
+    Glib::StaticMutex::Lock lock(filesMutex);
+    map<string, int>::const_iterator it = numbers.find(path);
+    if (it != numbers.end())
+        return it->second;
+
+    File *f = new File;
+    f->name = filename;
+    f->mapping = 0;
+    f->converted = text;
+    f->text = f->converted.data();
+    f->size = f->converted.size();
+    f->lines = lines;
+
+    return numbers[path] = append(f);
+}
+
+int SourceManager::append(File *f)
+{
+    const vector<File*> *old = static_cast<const vector<File*>*>(table);
+    vector<File*> *files = old ? new vector<File*>(*old) : new vector<File*>;
+    files->push_back(f);
+    tables.push_back(files);
+    g_atomic_pointer_set(&table, files);
+    return files->size() - 1;
+}
+
+const SourceManager::File & SourceManager::get(int file) const
+{
+    // A thread only knows the numbers of files added before it looks.
+    const vector<File*> *files = static_cast<const vector<File*>*>(g_atomic_pointer_get(&table));
+    assert(files && 0 <= file && file < int(files->size()));
+    return *(*files)[file];
+}
+
+const string & SourceManager::fileName(int file) const
+{
+    return get(file).name;
+}
+
+const char *SourceManager::begin(int file) const
+{
+    return get(file).text;
+}
+
+const char *SourceManager::end(int file) const
+{
+    const File & f = get(file);
+    return f.text + f.size;
+}
+
+const vector<int> & SourceManager::lineMap(int file) const
+{
+    return get(file).lines;
+}
+
+const char *SourceManager::lineStart(int file, unsigned offset) const
+{
+    const char *first = begin(file);
+    const char *p = first + offset;
+    while (p > first && p[-1] != '\n')
+        --p;
+    return p;
+}
+
+Glib::ustring SourceManager::lineText(int file, unsigned offset) const
+{
+    const char *start = lineStart(file, offset);
+    const char *last = end(file);
+    const char *eol = static_cast<const char*>(memchr(start, '\n', last - start));
+    return Glib::ustring(start, eol ? eol : last);
+}
+
+int SourceManager::column(int file, unsigned offset) const
+{
+    // Count characters, not bytes: skip UTF-8 continuation bytes.
+    int col = 0;
+    const char *last = begin(file) + offset;
+    for (const char *p = lineStart(file, offset); p < last; ++p)
+        if ((*p & 0xC0) != 0x80)
+            ++col;
+    return col;
+}
+
+void SourceManager::clear()
+{
+    Glib::StaticMutex::Lock lock(filesMutex);
+    if (!tables.empty())
+    {
+        vector<File*> & files = *tables.back();
+        for (vector<File*>::iterator it = files.begin(); it != files.end(); ++it)
+        {
+            if ((*it)->mapping)
+                g_mapped_file_unref((*it)->mapping);
+            delete *it;
+        }
+    }
+    for (vector< vector<File*>* >::iterator it = tables.begin(); it != tables.end(); ++it)
+        delete *it;
+    tables.clear();
+    table = 0;
+    numbers.clear();
+}
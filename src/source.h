@@ -0,0 +1,134 @@
+/** \file source.h
+ * Declaration of class SourceManager.
+ */
+
+#ifndef SOURCE_H
+#define SOURCE_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include <glibmm.h>
+
+using namespace std;
+
+/** File number of positions that do not belong to a source file. */
+const int NO_FILE = -1;
+
+/** \return the absolute path of \a filename with symbolic links and
+ * '.' and '..' components resolved, or \a filename itself if the
+ * file does not exist.
+ */
+string canonicalPath(const string & filename);
+
+/** An instance holds the text of every source file of a program.
+ * Each file is read once, by mapping it into memory, and stays
+ * there until the manager is cleared.  Tokens and error positions
+ * refer to the text by file number and byte offset; lines and
+ * columns are recovered from the text when they are needed.
+ * Files may be added and read by several threads at once; reading
+ * takes no lock, so the threads that parse files in parallel do not
+ * wait for each other.
+ */
+class SourceManager
+{
+    public:
+
+        /** Construct a manager with no files. */
+        SourceManager();
+
+        /** Release all files. */
+        ~SourceManager();
+
+        /** Read a source file, unless it has been read already.
+         * Files are identified by their canonical paths, so that a
+         * file reached by different names is read only once.
+         * \param filename is the full name/path of the file.
+         * \return the number of the file.
+         * \throw if the file cannot be opened.
+         */
+        int addFile(const string & filename);
+
+        /** Add source text that was extracted from a file, such as the
+         * code of a LaTeX document.  Positions in the text are reported
+         * as positions in the file.
+         * \param filename is the full name/path of the original file.
+         * \param text is the extracted text.
+         * \param lines gives, for each line of \a text, the number of
+         *        the line of the original file that it came from.
+         * \return the number of the file.
+         */
+        int addText(const string & filename, const string & text, const vector<int> & lines);
+
+        /** \return the name of file \a file. */
+        const string & fileName(int file) const;
+
+        /** \return the first byte of the text of file \a file. */
+        const char *begin(int file) const;
+
+        /** \return the end of the text of file \a file. */
+        const char *end(int file) const;
+
+        /** \return the original line numbers of the lines of file
+         * \a file, which are empty if the text is the file itself.
+         */
+        const vector<int> & lineMap(int file) const;
+
+        /** \return the line of file \a file that contains byte \a offset,
+         * without its newline.
+         */
+        Glib::ustring lineText(int file, unsigned offset) const;
+
+        /** \return the number of characters before byte \a offset
+         * on its line of file \a file.
+         */
+        int column(int file, unsigned offset) const;
+
+        /** Release all files. */
+        void clear();
+
+    private:
+
+        /** A source file, either mapped or (if the locale is not UTF-8,
+         * or the text was extracted) held in memory.
+         */
+        struct File
+        {
+            string name;
+            GMappedFile *mapping;
+            string converted;
+            const char *text;
+            size_t size;
+            vector<int> lines;
+        };
+
+        /** \return file \a file.  Files do not move once they have
+         * been added, so the result remains valid while other files
+         * are added.
+         */
+        const File & get(int file) const;
+
+        /** \return the start of the line of \a file that contains \a offset. */
+        const char *lineStart(int file, unsigned offset) const;
+
+        /** Add \a f, holding the lock.  \return its number. */
+        int append(File *f);
+
+        /** The files, by number, as a vector<File*>.  Adding a file
+         * replaces the vector with a longer copy, so that readers
+         * need no lock; old copies are kept until clear().
+         */
+        mutable volatile gpointer table;
+
+        /** Every copy of the table. */
+        vector< vector<File*>* > tables;
+
+        /** Maps canonical paths to file numbers. */
+        map<string, int> numbers;
+
+        // Not copyable: the manager owns the mappings.
+        SourceManager(const SourceManager &);
+        void operator=(const SourceManager &);
+};
+
+#endif
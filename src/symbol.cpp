@@ -0,0 +1,118 @@
+/** \file symbol.cpp
+ * Implementation of class Symbol.
+ */
+
+#include "symbol.h"
+
+#include <string>
+#include <tr1/unordered_map>
+#include <vector>
+#include <glibmm.h>
+
+using namespace std;
+
+/** Texts are stored in blocks of this many, which never move. */
+const unsigned BLOCK_SIZE = 1024;
+
+/** The texts of all symbols.  Symbol::str() reads them without a
+ * lock: a block is never moved or changed once a text in it has
+ * been handed out, and when the directory of blocks grows the old
+ * directory is kept, so a reader never sees freed memory.  A thread
+ * that holds a symbol obtained it from intern(), or from another
+ * thread that did, so the text is visible to it.
+ */
+struct SymbolPool
+{
+    SymbolPool() : size(0), capacity(0), blocks(0), directory(0)
+    {
+        add("");
+    }
+
+    /** Add \a text, which is not in the pool. \return its number. */
+    unsigned add(const string & text)
+    {
+        unsigned block = size / BLOCK_SIZE;
+        if (size % BLOCK_SIZE == 0)
+        {
+            if (block == capacity)
+            {
+                unsigned newCapacity = capacity ? 2 * capacity : 64;
+                string **newBlocks = new string*[newCapacity];
+                for (unsigned i = 0; i < capacity; ++i)
+                    newBlocks[i] = blocks[i];
+                directories.push_back(newBlocks);
+                capacity = newCapacity;
+                blocks = newBlocks;
+                g_atomic_pointer_set(&directory, newBlocks);
+            }
+            blocks[block] = new string[BLOCK_SIZE];
+        }
+        blocks[block][size % BLOCK_SIZE] = text;
+        numbers[text] = size;
+        return size++;
+    }
+
+    /** \return the text numbered \a num. */
+    const string & text(unsigned num)
+    {
+        string **current = static_cast<string**>(g_atomic_pointer_get(&directory));
+        return current[num / BLOCK_SIZE][num % BLOCK_SIZE];
+    }
+
+    /** The number of texts. */
+    unsigned size;
+
+    /** The number of blocks that the directory can hold. */
+    unsigned capacity;
+
+    /** The blocks of texts, as seen by the thread that adds texts. */
+    string **blocks;
+
+    /** The blocks of texts, as seen by readers. */
+    volatile gpointer directory;
+
+    /** Every directory made, which are never freed. */
+    vector<string**> directories;
+
+    /** The number of each text. */
+    tr1::unordered_map<string, unsigned> numbers;
+};
+
+/** Guards additions to the pool, which is shared by the threads that
+ * scan source files in parallel.  A static mutex needs no construction,
+ * so it may be used before the thread system is initialized.
+ */
+static Glib::StaticMutex poolMutex = GLIBMM_STATIC_MUTEX_INIT;
+
+/** The pool is constructed on first use, so that symbols
+ * may be created during static initialization.
+ */
+static SymbolPool & pool()
+{
+    static SymbolPool thePool;
+    return thePool;
+}
+
+Symbol::Symbol(const string & text) : num(intern(text))
+{}
+
+Symbol::Symbol(const char *text) : num(intern(text))
+{}
+
+Symbol::Symbol(const char *first, const char *last) : num(intern(string(first, last)))
+{}
+
+const string & Symbol::str() const
+{
+    return pool().text(num);
+}
+
+unsigned Symbol::intern(const string & text)
+{
+    Glib::StaticMutex::Lock lock(poolMutex);
+    SymbolPool & p = pool();
+    tr1::unordered_map<string, unsigned>::const_iterator it = p.numbers.find(text);
+    if (it != p.numbers.end())
+        return it->second;
+    return p.add(text);
+}
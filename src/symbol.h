@@ -0,0 +1,76 @@
+/** \file symbol.h
+ * Declaration of class Symbol.
+ */
+
+#ifndef SYMBOL_H
+#define SYMBOL_H
+
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+/** An instance is an interned string.  Each distinct text is stored
+ * once, in a pool that lasts as long as the compiler, and symbols
+ * with the same text have the same number.  Copying and comparing
+ * symbols is as cheap as copying and comparing integers.
+ */
+class Symbol
+{
+    public:
+
+        /** Construct the symbol whose text is empty. */
+        Symbol() : num(0) {}
+
+        /** Construct the symbol for \a text, adding it to the pool if necessary. */
+        Symbol(const string & text);
+
+        /** Construct the symbol for \a text, adding it to the pool if necessary. */
+        Symbol(const char *text);
+
+        /** Construct the symbol for the characters [\a first, \a last). */
+        Symbol(const char *first, const char *last);
+
+        /** \return the text of the symbol. */
+        const string & str() const;
+
+        /** \return the number that identifies the symbol. */
+        unsigned id() const
+        {
+            return num;
+        }
+
+        /** Symbols are equal if they have the same text. */
+        bool operator==(const Symbol & other) const
+        {
+            return num == other.num;
+        }
+
+        /** Symbols are equal if they have the same text. */
+        bool operator!=(const Symbol & other) const
+        {
+            return num != other.num;
+        }
+
+        /** Order symbols by number (not alphabetically), for use in maps. */
+        bool operator<(const Symbol & other) const
+        {
+            return num < other.num;
+        }
+
+        /** Write the text of a symbol. */
+        friend ostream & operator<<(ostream & os, const Symbol & sym)
+        {
+            return os << sym.str();
+        }
+
+    private:
+
+        /** Find or add \a text in the pool. */
+        static unsigned intern(const string & text);
+
+        /** Index of the text in the pool. */
+        unsigned num;
+};
+
+#endif
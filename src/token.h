@@ -5,7 +5,9 @@
 #ifndef TOKEN_H
 #define TOKEN_H
 
+#include "context.h"
 #include "error.h"
+#include "symbol.h"
 
 #include <string>
 #include <glibmm.h>
@@ -133,7 +135,12 @@ LP,          // (
 
 //\}
 
-/** An instance is a token created by the scanner. */
+/** An instance is a token created by the scanner.
+ * Tokens are kept in a vector, so they are small (16 bytes):
+ * the text is an interned symbol and the position is a file number,
+ * byte offset and line number in the source text held by the source
+ * manager of the compilation.
+ */
 class Token
 {
     public:
@@ -141,29 +148,50 @@ class Token
         /** Default constructor constructs a dummy (useless) token.
          * All data members are public, but should only be used by scanner methods.
          */
-        Token(Errpos ep, TokenKind kind = END_MARKER, Glib::ustring value = "", bool keyword = false)
-            : ep(ep), kind(kind), value(value), keyword(keyword)
+        Token(TokenKind kind = END_MARKER, Symbol symbol = Symbol(), bool keyword = false,
+              int file = NO_FILE, unsigned offset = 0, int line = 0)
+            : kind(kind), keyword(keyword), file(file), symbol(symbol), offset(offset), line(line)
+        {
+        }
+
+        /** \return the string actually read by the scanner. */
+        const string & value() const
         {
+            return symbol.str();
+        }
+
+        /** \return the position of the token in the input file. */
+        Errpos ep() const
+        {
+            if (file == NO_FILE)
+                return Errpos();
+            return Errpos(file, offset, line);
         }
 
         /** Write token description to stream:
           used by the parser for reporting errors. */
         friend ostream & operator<<(ostream & os, const Token & tok)
         {
-            return os << tok.ep;
+            return os << tok.ep();
         }
 
-        /** Position in the input file. */
-        Errpos ep;
-
         /** The kind of token. */
-        TokenKind kind;
-
-        /** The string actually read by the scanner. */
-        Glib::ustring value;
+        TokenKind kind : 8;
 
         /** The token is a keyword. */
         bool keyword;
+
+        /** Number of the source file, or NO_FILE. */
+        short file;
+
+        /** The string actually read by the scanner. */
+        Symbol symbol;
+
+        /** Offset of the first byte of the token in the source file. */
+        unsigned offset;
+
+        /** Number of the source line. */
+        int line;
 };
 
 #endif
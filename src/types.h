@@ -3,6 +3,8 @@
 #ifndef TYPES_H
 #define TYPES_H
 
+#include "symbol.h"
+
 #include <list>
 #include <set>
 #include <string>
@@ -21,7 +23,7 @@ typedef BlockList::iterator BlockIter;
 class FuncDef;
 typedef std::vector<FuncDef*>::const_iterator FuncIter;
 
-typedef std::set<std::string> StringSet;
+typedef std::set<Symbol> SymbolSet;
 
 // Lightning stuff
 
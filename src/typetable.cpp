@@ -0,0 +1,59 @@
+/** \file typetable.cpp
+ * Implementation of class TypeTable.
+ */
+
+#include "typetable.h"
+#include "ast.h"
+#include "context.h"
+
+using namespace std;
+
+TypeTable::TypeTable() : next(FIRST_TYPE_ID)
+{}
+
+unsigned TypeTable::id(Node type)
+{
+    if (type->typeId >= 0)
+        return type->typeId;
+    return CompilationContext::current().types.number(type);
+}
+
+unsigned TypeTable::number(Node type)
+{
+    unsigned num;
+    Node value = type->kind() == NAME_NODE ? type->getValue() : 0;
+    if (value && value != type)
+        num = id(value);
+    else if (type->isMapType())
+    {
+        pair<unsigned, unsigned> key(id(type->getDomainType()), id(type->getRangeType()));
+        map<pair<unsigned, unsigned>, unsigned>::const_iterator it = mapTypes.find(key);
+        if (it == mapTypes.end())
+            it = mapTypes.insert(make_pair(key, next++)).first;
+        num = it->second;
+    }
+    else if (type->isArrayType())
+        num = ARRAY_TYPE_ID;
+    else
+        num = next++;
+    type->typeId = num;
+    return num;
+}
+
+void TypeTable::numberBasicTypes()
+{
+    // In the order of TypeId.
+    Node basicTypes[] =
+    {
+        BaseNode::theVoidNode, BaseNode::theBoolNode,
+        BaseNode::theByteNode, BaseNode::theUnsignedByteNode,
+        BaseNode::theIntegerNode, BaseNode::theUnsignedIntegerNode,
+        BaseNode::theFloatNode, BaseNode::theDecimalNode,
+        BaseNode::theCharNode, BaseNode::theTextNode,
+        BaseNode::theInputFileNode, BaseNode::theOutputFileNode
+    };
+    for (unsigned i = 0; i < NUM_BASIC_TYPES; ++i)
+        basicTypes[i]->typeId = i;
+    BaseNode::theArrayNode->typeId = ARRAY_TYPE_ID;
+    BaseNode::theEnumNode->typeId = ENUM_TYPE_ID;
+}
@@ -0,0 +1,85 @@
+/** \file typetable.h
+ * Declaration of class TypeTable.
+ */
+
+#ifndef TYPETABLE_H
+#define TYPETABLE_H
+
+#include "types.h"
+
+#include <map>
+#include <utility>
+
+/** The canonical numbers of the types that are the same in every
+ * compilation.  The basic types come first, so that the numbers
+ * below NUM_BASIC_TYPES index tables of basic types.
+ */
+enum TypeId
+{
+    VOID_TYPE_ID,
+    BOOL_TYPE_ID,
+    BYTE_TYPE_ID,
+    UNSIGNED_BYTE_TYPE_ID,
+    INTEGER_TYPE_ID,
+    UNSIGNED_INTEGER_TYPE_ID,
+    FLOAT_TYPE_ID,
+    DECIMAL_TYPE_ID,
+    CHAR_TYPE_ID,
+    TEXT_TYPE_ID,
+    INPUT_FILE_TYPE_ID,
+    OUTPUT_FILE_TYPE_ID,
+    NUM_BASIC_TYPES,
+
+    /** All array types: arrays are equal whatever their elements. */
+    ARRAY_TYPE_ID = NUM_BASIC_TYPES,
+
+    /** BaseNode::theEnumNode. */
+    ENUM_TYPE_ID,
+
+    /** The first number given to a type of a particular compilation. */
+    FIRST_TYPE_ID
+};
+
+/** An instance gives the types of a compilation canonical numbers,
+ * so that two types are the same if and only if their numbers are
+ * equal.  A name of a type has the number of the type that it names,
+ * and map types with the same domain and range share a number.  Every
+ * other type, such as an enumeration, is distinct from all others.
+ *
+ * A type is numbered when it is first compared, which is after
+ * binding, and the number is kept in its node.
+ */
+class TypeTable
+{
+    public:
+
+        /** Construct a table in which no types have been numbered. */
+        TypeTable();
+
+        /** \return the canonical number of \a type, numbering it in the
+         * current compilation if necessary.
+         */
+        static unsigned id(Node type);
+
+        /** Number the types that are the same in every compilation.
+         *  Call this once at startup, before any compilation.
+         */
+        static void numberBasicTypes();
+
+    private:
+
+        // Not copyable: types refer to the numbers that it gives.
+        TypeTable(const TypeTable &);
+        void operator=(const TypeTable &);
+
+        /** \return the number of \a type, which has not been numbered. */
+        unsigned number(Node type);
+
+        /** The numbers of map types, by domain and range numbers. */
+        std::map<std::pair<unsigned, unsigned>, unsigned> mapTypes;
+
+        /** The number for the next distinct type. */
+        unsigned next;
+};
+
+#endif